@@ -6,12 +6,17 @@
 #ifndef AKQHOMOTOPICPATHS_H
 #define	AKQHOMOTOPICPATHS_H
 
-#include <list>
-#include <map>
+#include <atomic>
+#include <cstddef>
 #include <vector>
-#include <boost/bimap.hpp>
+#include <boost/foreach.hpp>
 #include <capd/complex/AKQStrategy.hpp>
 
+#include "FreeWord.h"
+#include "HomotopicPathsStats.h"
+#include "InlineVector.h"
+#include "WordArena.h"
+
 template <typename Supplier>
 class AKQHomotopicPaths
 {
@@ -24,11 +29,22 @@ public:
     typedef typename OutputSComplex::Id         OutputCellId;
     typedef capd::complex::AKQReduceStrategy<InputSComplex, OutputSComplex, Scalar>    Strategy;
     typedef typename OutputSComplex::Cell       OutputCell;
-    typedef std::vector<std::pair<OutputCellId, int> > OutputChain;
+    typedef WordArena<OutputCellId>             OutputChains;
 
     AKQHomotopicPaths(Supplier *complexSupplier, Strategy *strategy);
 
-    OutputChain GetHomotopicBoundary(const OutputCellId& cell);
+    // appends homotopic boundary of the cell as a new word
+    void GetHomotopicBoundary(const OutputCellId& cell, OutputChains& boundaries);
+
+    // appends homotopic boundaries of all the cells (in the given order),
+    // cells are split into chunks processed by threadsCount threads
+    // (threadsCount <= 0 means one thread per core)
+    void GetHomotopicBoundaries(const std::vector<OutputCellId>& cells,
+                                OutputChains& boundaries,
+                                int threadsCount);
+
+    // counters collected so far (merged from all the threads)
+    HomotopicPathsStats GetStats() const;
 
 private:
 
@@ -36,25 +52,66 @@ private:
     typedef typename InputSComplex::Cell                InputCell;
     typedef std::vector<std::pair<InputCellId, int> >   InputChain;
     typedef std::pair<InputCellId, int>                 PathCell;
-    typedef std::list<PathCell>                         Path;
-    typedef std::map<InputCellId, Path>                 PathsMap;
-    typedef typename PathsMap::iterator                 PathsMapIterator;
-    typedef boost::bimap<InputCellId, OutputCellId>     AcesMap;
+    typedef InlineVector<PathCell, 4>                   Path;
+    // homotopic path of a queen is described by a short program: a sequence
+    // of aces and other queens, built from the boundary of its king
+    typedef std::vector<PathCell>                       PathProgram;
     typedef typename InputSComplex::Iterators::BdCells  BdCells;
+    // reduced path in the output complex, subpaths are shared
+    typedef FreeWord<typename OutputChains::Letter>     HomotopicWord;
+    typedef std::vector<std::pair<InputCellId, PathProgram> >   ResolveStack;
+
+    enum QueenState
+    {
+        EMPTY = 0,
+        STORING,
+        READY,
+    };
+
+    struct WordAppender
+    {
+        OutputChains*   chains;
+
+        void operator()(typename OutputChains::Letter letter)
+        {
+            chains->Append(letter);
+        }
+    };
+
+    static const size_t NOT_ACE = static_cast<size_t>(-1);
+    static const size_t CELLS_CHUNK_SIZE = 64;
 
     void ComputeAcesMap();
-    void GetHomotopicPath(const Path& path, Path& outPath);
-    void GetHomotopicPath(const PathCell& cell, Path& outPath);
-    PathsMapIterator GetQueenHomotopicPath(InputCellId cellId);
-    void ReverseNegate(const Path& path, Path& outPath);
-    void Negate(Path& path);
+    void GetHomotopicBoundary(const OutputCellId& cell, OutputChains& boundaries,
+                              HomotopicPathsStats& stats);
+    void ProcessChunks(const std::vector<OutputCellId>* cells,
+                       std::vector<OutputChains>* chunks,
+                       std::atomic<size_t>* nextChunk,
+                       HomotopicPathsStats* stats);
+    HomotopicWord GetHomotopicWord(const PathCell& cell, HomotopicPathsStats& stats);
+    // path of a king, an ace or an already resolved queen
+    HomotopicWord GetResolvedWord(const PathCell& cell);
+    HomotopicWord Join(const HomotopicWord& a, const HomotopicWord& b,
+                       HomotopicPathsStats& stats, bool memoized);
+    void ResolveQueenPaths(InputCellId cellId, HomotopicPathsStats& stats);
+    void BuildQueenProgram(InputCellId cellId, PathProgram& program);
+    void AppendToProgram(PathProgram& program, const PathCell& cell);
+    void PublishQueenPath(InputCellId cellId, const HomotopicWord& path,
+                          HomotopicPathsStats& stats);
+    bool IsResolved(InputCellId cellId) const;
 
     Supplier*       _complexSupplier;
     Strategy*       _strategy;
     InputSComplex*  _originalComplex;
     OutputSComplex* _outputComplex;
-    PathsMap        _queenPaths;
-    AcesMap         _acesMap;
+    // tables indexed by input cell id (the same ids as _strategy->akq),
+    // a path is valid once its state is READY
+    std::vector<HomotopicWord>      _queenPaths;
+    std::vector<std::atomic<char> > _queenStates;
+    std::vector<size_t>             _aceIndices;
+    // indexed by output cell id
+    std::vector<InputCellId>        _aces;
+    HomotopicPathsStats             _stats;
 };
 
 #include "AKQHomotopicPaths.hpp"
@@ -8,6 +8,15 @@
 
 #include "AKQHomotopicPaths.h"
 
+#include <algorithm>
+#include <thread>
+
+template <typename Supplier>
+const size_t AKQHomotopicPaths<Supplier>::NOT_ACE;
+
+template <typename Supplier>
+const size_t AKQHomotopicPaths<Supplier>::CELLS_CHUNK_SIZE;
+
 template <typename Supplier>
 AKQHomotopicPaths<Supplier>::AKQHomotopicPaths(Supplier* complexSupplier,
                                                Strategy* strategy)
@@ -18,148 +27,262 @@ AKQHomotopicPaths<Supplier>::AKQHomotopicPaths(Supplier* complexSupplier,
     assert(_strategy != 0);
     _originalComplex = &_strategy->getComplex();
     _outputComplex = _strategy->getOutputComplex();
+    _queenPaths.resize(_strategy->akq.size());
+    // all states are EMPTY (zero initialized)
+    std::vector<std::atomic<char> >(_strategy->akq.size()).swap(_queenStates);
     ComputeAcesMap();
 }
 
 template <typename Supplier>
 void AKQHomotopicPaths<Supplier>::ComputeAcesMap()
 {
-    OutputCellId id = OutputCellId(0);
+    // i-th ace of the strategy becomes i-th cell of the output complex
+    _aceIndices.assign(_strategy->akq.size(), NOT_ACE);
+    _aces.clear();
+    _aces.reserve(_strategy->aces.size());
     BOOST_FOREACH(InputCellId ace, _strategy->aces)
     {
-        _acesMap.insert(typename AcesMap::value_type(ace, id++));
+        assert(static_cast<size_t>(ace) < _aceIndices.size());
+        _aceIndices[ace] = _aces.size();
+        _aces.push_back(ace);
     }
 }
 
 template <typename Supplier>
-typename AKQHomotopicPaths<Supplier>::OutputChain
-AKQHomotopicPaths<Supplier>::GetHomotopicBoundary(const OutputCellId& cellId)
+void AKQHomotopicPaths<Supplier>::GetHomotopicBoundary(const OutputCellId& cellId,
+                                                       OutputChains& boundaries)
+{
+    GetHomotopicBoundary(cellId, boundaries, _stats);
+}
+
+template <typename Supplier>
+void AKQHomotopicPaths<Supplier>::GetHomotopicBoundary(const OutputCellId& cellId,
+                                                       OutputChains& boundaries,
+                                                       HomotopicPathsStats& stats)
 {
     // cell needs to be an ace
-    assert(_acesMap.right.find(cellId) != _acesMap.right.end());
+    assert(static_cast<size_t>(cellId) < _aces.size());
     // we get an original cell
-    InputCell originalCell = (*_originalComplex)[_acesMap.right.at(cellId)];
+    InputCell originalCell = (*_originalComplex)[_aces[cellId]];
     assert(_strategy->akq[originalCell.getId()] == Strategy::ACE);
 
-    // we take its boundary cells and create a homotopic path
+    // we take its boundary cells and join homotopic paths of each of them
+    // (words are reduced at the joins), letters are copied only here
     Path bdPath = _complexSupplier->GetOrdered2Boundary(_originalComplex, originalCell.getId());
-    Path homotopicPath;
+    HomotopicWord boundary;
     for (typename Path::iterator jt = bdPath.begin(); jt != bdPath.end(); ++jt)
     {
-        Path tmpPath;
-        GetHomotopicPath(*jt, tmpPath);
-        homotopicPath.insert(homotopicPath.end(), tmpPath.begin(), tmpPath.end());
+        boundary = Join(boundary, GetHomotopicWord(*jt, stats), stats, false);
     }
+    WordAppender appender = { &boundaries };
+    boundary.Visit(appender);
+    boundaries.EndWord();
+    stats.AddBoundaryLength(boundary.Length());
+}
 
-    // finally we need to map original complex cells' ids to the output complex cells' ids
-    OutputChain boundary;
-    for (typename Path::iterator jt = homotopicPath.begin(); jt != homotopicPath.end(); ++jt)
+template <typename Supplier>
+void AKQHomotopicPaths<Supplier>::GetHomotopicBoundaries(const std::vector<OutputCellId>& cells,
+                                                         OutputChains& boundaries,
+                                                         int threadsCount)
+{
+    if (threadsCount <= 0)
     {
-        // only ACES can be present in the final homotopic path
-        assert(_strategy->akq[jt->first] == Strategy::ACE);
-        assert(_acesMap.left.find(jt->first) != _acesMap.left.end());
-        OutputCell ace = (*_outputComplex)[_acesMap.left.at(jt->first)];
-        int ci = jt->second;//_outputComplex->coincidenceIndex(cell, ace);
-        assert(ci != 0);
-        boundary.push_back(std::pair<OutputCellId, int>(ace.getId(), ci));
+        threadsCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    size_t chunksCount = (cells.size() + CELLS_CHUNK_SIZE - 1) / CELLS_CHUNK_SIZE;
+    threadsCount = static_cast<int>(std::min(static_cast<size_t>(std::max(threadsCount, 1)), chunksCount));
+    if (threadsCount <= 1)
+    {
+        typename std::vector<OutputCellId>::const_iterator it = cells.begin();
+        typename std::vector<OutputCellId>::const_iterator itEnd = cells.end();
+        for ( ; it != itEnd; ++it)
+        {
+            GetHomotopicBoundary(*it, boundaries, _stats);
+        }
+        return;
+    }
+
+    // threads take consecutive chunks of cells, each chunk is written
+    // to its own arena, so the order of the words can be restored
+    std::vector<OutputChains> chunks(chunksCount);
+    std::atomic<size_t> nextChunk(0);
+    std::vector<HomotopicPathsStats> threadsStats(threadsCount);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadsCount; i++)
+    {
+        threads.push_back(std::thread(&AKQHomotopicPaths::ProcessChunks, this,
+                                      &cells, &chunks, &nextChunk, &threadsStats[i]));
+    }
+    ProcessChunks(&cells, &chunks, &nextChunk, &threadsStats[0]);
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+    for (int i = 0; i < threadsCount; i++)
+    {
+        _stats.Merge(threadsStats[i]);
+    }
+
+    for (size_t i = 0; i < chunksCount; i++)
+    {
+        boundaries.AppendWords(chunks[i]);
+        OutputChains().Swap(chunks[i]);
     }
-    return boundary;
 }
 
 template <typename Supplier>
-void AKQHomotopicPaths<Supplier>::GetHomotopicPath(const Path& path, Path& outPath)
+HomotopicPathsStats AKQHomotopicPaths<Supplier>::GetStats() const
 {
-    outPath.clear();
-    typename Path::const_iterator it = path.begin();
-    typename Path::const_iterator itEnd = path.end();
-    for ( ; it != itEnd; it++)
-    {
-        Path tmpPath;
-        GetHomotopicPath(*it, tmpPath);
+    HomotopicPathsStats stats = _stats;
+    stats._bytesHeld += _queenPaths.capacity() * sizeof(HomotopicWord) + _queenStates.size();
+    return stats;
+}
 
-        // reducing words
-        bool reduced = false;
-        while (!reduced && outPath.size() > 0 && tmpPath.size() > 0)
+template <typename Supplier>
+void AKQHomotopicPaths<Supplier>::ProcessChunks(const std::vector<OutputCellId>* cells,
+                                                std::vector<OutputChains>* chunks,
+                                                std::atomic<size_t>* nextChunk,
+                                                HomotopicPathsStats* stats)
+{
+    size_t chunk = (*nextChunk)++;
+    while (chunk < chunks->size())
+    {
+        size_t begin = chunk * CELLS_CHUNK_SIZE;
+        size_t end = std::min(begin + CELLS_CHUNK_SIZE, cells->size());
+        for (size_t i = begin; i < end; i++)
         {
-            if (outPath.back().first == tmpPath.front().first)
-            {
-                int sum = outPath.back().second + tmpPath.front().second;
-                if (sum == 0)
-                {
-                    // removing last element from current list
-                    typename Path::iterator last = outPath.end();
-                    last--;
-                    outPath.erase(last);
-                    tmpPath.erase(tmpPath.begin());
-                }
-                else
-                {
-                    outPath.back().second = sum;
-                    tmpPath.erase(tmpPath.begin());
-                }
-            }
-            else
-            {
-                reduced = true;
-            }
+            GetHomotopicBoundary((*cells)[i], (*chunks)[chunk], *stats);
         }
+        chunk = (*nextChunk)++;
+    }
+}
 
-        // if there's still something left just add it at the end
-        outPath.insert(outPath.end(), tmpPath.begin(), tmpPath.end());
+template <typename Supplier>
+typename AKQHomotopicPaths<Supplier>::HomotopicWord
+AKQHomotopicPaths<Supplier>::GetHomotopicWord(const PathCell& cell, HomotopicPathsStats& stats)
+{
+    // lookups of queens from boundaries of 2-cells are counted, the ones
+    // made while a queen is resolved always find their dependencies ready
+    if (_strategy->akq[cell.first] == Strategy::QUEEN)
+    {
+        if (IsResolved(cell.first))
+        {
+            stats._memoHits++;
+        }
+        else
+        {
+            stats._memoMisses++;
+            ResolveQueenPaths(cell.first, stats);
+        }
     }
+    return GetResolvedWord(cell);
 }
 
 template <typename Supplier>
-void AKQHomotopicPaths<Supplier>::GetHomotopicPath(const PathCell& cell, Path& outPath)
+typename AKQHomotopicPaths<Supplier>::HomotopicWord
+AKQHomotopicPaths<Supplier>::GetResolvedWord(const PathCell& cell)
 {
+    assert(cell.second != 0);
     AKQType type = _strategy->akq[cell.first];
     if (type == Strategy::KING)
     {
         // no path
-        outPath.clear();
+        return HomotopicWord();
     }
-    else if (type == Strategy::ACE)
+    if (type == Strategy::ACE)
     {
-        // critical cell
-        outPath.clear();
-        outPath.push_back(cell);
+        // critical cell, we need to map original complex cell's id
+        // to the output complex cell's id
+        assert(_aceIndices[cell.first] != NOT_ACE);
+        OutputCell ace = (*_outputComplex)[OutputCellId(_aceIndices[cell.first])];
+        return HomotopicWord(OutputChains::MakeLetter(ace.getId(), 1)).Power(cell.second);
     }
-    else
+    assert(type == Strategy::QUEEN);
+    assert(IsResolved(cell.first));
+    return _queenPaths[cell.first].Power(cell.second);
+}
+
+template <typename Supplier>
+typename AKQHomotopicPaths<Supplier>::HomotopicWord
+AKQHomotopicPaths<Supplier>::Join(const HomotopicWord& a, const HomotopicWord& b,
+                                  HomotopicPathsStats& stats, bool memoized)
+{
+    HomotopicWord result = HomotopicWord::Concat(a, b);
+    stats._joinReductions += (a.Length() + b.Length() - result.Length()) / 2;
+    if (memoized && !result.SharesNode(a) && !result.SharesNode(b))
+    {
+        stats._bytesHeld += result.NodeBytes();
+    }
+    return result;
+}
+
+template <typename Supplier>
+void AKQHomotopicPaths<Supplier>::ResolveQueenPaths(InputCellId cellId,
+                                                    HomotopicPathsStats& stats)
+{
+    // if the path has been already computed, there is nothing to do
+    if (IsResolved(cellId))
     {
-        assert(type == Strategy::QUEEN);
-        PathsMapIterator it = GetQueenHomotopicPath(cell.first);
-        assert(it != _queenPaths.end());
-        if (cell.second > 0)
+        return;
+    }
+
+    // queens are resolved in post-order (dependencies first) with explicit
+    // stack, gradient paths are acyclic so the traversal terminates;
+    // each program is published exactly once, when all queens it references
+    // have been already published (possibly by other threads)
+    ResolveStack stack;
+    stack.push_back(std::make_pair(cellId, PathProgram()));
+    BuildQueenProgram(cellId, stack.back().second);
+    while (!stack.empty())
+    {
+        size_t top = stack.size() - 1;
+        InputCellId queen = stack[top].first;
+        if (IsResolved(queen))
         {
-            outPath.assign(it->second.begin(), it->second.end());
+            // reached by another path in the meantime
+            stack.pop_back();
+            continue;
         }
-        else
+        for (size_t i = 0; i < stack[top].second.size(); i++)
         {
-            ReverseNegate(it->second, outPath);
+            InputCellId next = stack[top].second[i].first;
+            if (_strategy->akq[next] == Strategy::QUEEN &&
+                !IsResolved(next))
+            {
+                stack.push_back(std::make_pair(next, PathProgram()));
+                BuildQueenProgram(next, stack.back().second);
+            }
+        }
+        if (stack.size() - 1 == top)
+        {
+            // all the referenced paths are ready, so joining them
+            // does not go any deeper
+            const PathProgram& program = stack[top].second;
+            HomotopicWord path;
+            typename PathProgram::const_iterator it = program.begin();
+            typename PathProgram::const_iterator itEnd = program.end();
+            for ( ; it != itEnd; ++it)
+            {
+                path = Join(path, GetResolvedWord(*it), stats, true);
+            }
+            PublishQueenPath(queen, path, stats);
+            stack.pop_back();
         }
     }
 }
 
 template <typename Supplier>
-typename AKQHomotopicPaths<Supplier>::PathsMapIterator
-AKQHomotopicPaths<Supplier>::GetQueenHomotopicPath(InputCellId cellId)
+void AKQHomotopicPaths<Supplier>::BuildQueenProgram(InputCellId cellId, PathProgram& program)
 {
     // we can only compute homotopic path for QUEEN cell
     assert(_strategy->akq[cellId] == Strategy::QUEEN);
 
-    // if the path has been already computed, we return it
-    PathsMapIterator hpIt = _queenPaths.find(cellId);
-    if (hpIt != _queenPaths.end())
-    {
-        return hpIt;
-    }
-
     Path prevCells;
     Path nextCells;
     Path* currentCells = &prevCells;
     int orientation = 0;
 
-    // then, we take a boundary of KING cell and compute
+    // we take a boundary of KING cell and compute
     // alternative path for traversing given QUEEN cell
     Path boundary = _complexSupplier->GetOrdered2Boundary(_originalComplex, _strategy->kerKing[cellId]);
     typename Path::iterator it = boundary.begin();
@@ -173,57 +296,97 @@ AKQHomotopicPaths<Supplier>::GetQueenHomotopicPath(InputCellId cellId)
             orientation = ci;
             currentCells = &nextCells;
         }
-        else
+        else if (_strategy->akq[it->first] != Strategy::KING)
         {
+            // kings have empty paths, so they are skipped
             currentCells->push_back(*it);
         }
     }
     assert(orientation != 0);
 
     // based on orientation of QUEEN cell we join two paths ("from" it and "to")
-    Path bdPath;
+    // referencing other cells instead of expanding their paths
+    program.clear();
+    program.reserve(prevCells.size() + nextCells.size());
     if (orientation > 0)
     {
-        Path tmp;
-        ReverseNegate(prevCells, tmp);
-        bdPath.insert(bdPath.end(), tmp.begin(), tmp.end());
-        ReverseNegate(nextCells, tmp);
-        bdPath.insert(bdPath.end(), tmp.begin(), tmp.end());
+        typename Path::iterator jt;
+        for (jt = prevCells.end(); jt != prevCells.begin(); )
+        {
+            --jt;
+            AppendToProgram(program, PathCell(jt->first, -jt->second));
+        }
+        for (jt = nextCells.end(); jt != nextCells.begin(); )
+        {
+            --jt;
+            AppendToProgram(program, PathCell(jt->first, -jt->second));
+        }
     }
     else
     {
-        bdPath.insert(bdPath.end(), nextCells.begin(), nextCells.end());
-        bdPath.insert(bdPath.end(), prevCells.begin(), prevCells.end());
+        typename Path::iterator jt;
+        for (jt = nextCells.begin(); jt != nextCells.end(); ++jt)
+        {
+            AppendToProgram(program, *jt);
+        }
+        for (jt = prevCells.begin(); jt != prevCells.end(); ++jt)
+        {
+            AppendToProgram(program, *jt);
+        }
     }
-
-    // finally we need to compute homotopic paths for every cell on path
-    Path homotopicPath;
-    GetHomotopicPath(bdPath, homotopicPath);
-
-    return _queenPaths.insert(std::make_pair(cellId, homotopicPath)).first;
 }
 
 template <typename Supplier>
-void AKQHomotopicPaths<Supplier>::ReverseNegate(const Path& path, Path& outPath)
+void AKQHomotopicPaths<Supplier>::AppendToProgram(PathProgram& program, const PathCell& cell)
 {
-    outPath.clear();
-    typename Path::const_reverse_iterator it = path.rbegin();
-    typename Path::const_reverse_iterator itEnd = path.rend();
-    for ( ; it != itEnd; ++it)
+    // reducing words at the join
+    if (program.size() > 0 && program.back().first == cell.first)
     {
-        outPath.push_back(std::make_pair(it->first, -it->second));
+        int sum = program.back().second + cell.second;
+        if (sum == 0)
+        {
+            program.pop_back();
+        }
+        else
+        {
+            program.back().second = sum;
+        }
+    }
+    else
+    {
+        program.push_back(cell);
     }
 }
 
 template <typename Supplier>
-void AKQHomotopicPaths<Supplier>::Negate(Path& path)
+void AKQHomotopicPaths<Supplier>::PublishQueenPath(InputCellId cellId,
+                                                   const HomotopicWord& path,
+                                                   HomotopicPathsStats& stats)
 {
-    typename Path::iterator it = path.begin();
-    typename Path::iterator itEnd = path.end();
-    for ( ; it != itEnd; ++it)
+    char expected = EMPTY;
+    if (_queenStates[cellId].compare_exchange_strong(expected, static_cast<char>(STORING)))
+    {
+        _queenPaths[cellId] = path;
+        stats._queensResolved++;
+        stats.AddPathLength(path.Length());
+        // release: the path (and all paths it shares) is visible
+        // to every thread that reads READY state
+        _queenStates[cellId].store(READY, std::memory_order_release);
+    }
+    else
     {
-        it->second = -it->second;
+        // other thread is storing the same path right now
+        while (!IsResolved(cellId))
+        {
+            std::this_thread::yield();
+        }
     }
 }
 
+template <typename Supplier>
+bool AKQHomotopicPaths<Supplier>::IsResolved(InputCellId cellId) const
+{
+    return _queenStates[cellId].load(std::memory_order_acquire) == READY;
+}
+
 #endif	/* AKQHOMOTOPICPATHS_HPP */
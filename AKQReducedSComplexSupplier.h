@@ -15,6 +15,10 @@
 
 #include "DebugComplexType.h"
 #include "FGLogger.h"
+#include "FGOptions.h"
+#include "InlineVector.h"
+#include "SComplexFactory.h"
+#include "WordArena.h"
 
 template <typename Traits>
 class AKQReducedSComplexSupplier
@@ -38,6 +42,9 @@ private:
     typedef capd::complex::Coreduction<Strategy, Scalar, Int> Algorithm;
     typedef boost::shared_ptr<Algorithm>        AlgorithmPtr;
 
+    typedef typename SComplexFactory<InputSComplex>::Dims               Dims;
+    typedef typename SComplexFactory<InputSComplex>::KappaMapBufferType KappaMap;
+
 public:
 
     typedef Traits                              HomologyTraits;
@@ -46,16 +53,17 @@ public:
     typedef std::set<Id>                        Cells;
     typedef std::vector<Cells>                  CellsByDim;
     typedef std::vector<std::pair<Id, int> >    Chain;
+    typedef WordArena<Id>                       Chains;
 
-    AKQReducedSComplexSupplier(const char* filename);
-    AKQReducedSComplexSupplier(DebugComplexType type);
-    AKQReducedSComplexSupplier(InputSComplexPtr inputSComplex);
+    AKQReducedSComplexSupplier(const char* filename, const FGOptions& options = FGOptions());
+    AKQReducedSComplexSupplier(DebugComplexType type, const FGOptions& options = FGOptions());
+    AKQReducedSComplexSupplier(InputSComplexPtr inputSComplex, const FGOptions& options = FGOptions());
 
-    bool GetCells(CellsByDim& cellsByDim, std::map<Id, Chain>& _2Boundaries);
+    bool GetCells(CellsByDim& cellsByDim, Chains& _2Boundaries);
     Chain GetBoundary(const Id& cellId);
 
     template <typename ComplexType>
-    std::list<std::pair<typename ComplexType::Id, int> >
+    InlineVector<std::pair<typename ComplexType::Id, int>, 4>
     GetOrdered2Boundary(ComplexType* complex, const typename ComplexType::Id& cellId);
 
     void PrintDebug();
@@ -63,10 +71,21 @@ public:
 private:
 
     void CreateAlgorithm();
+    // creates the complex from the kappa map with cells in the order given
+    // by the options, keeping the run which leaves the least extracted cells
+    void CreateAlgorithm(Dims& dims, KappaMap& kappaMap);
+    // cells of complexes which are not created from kappa maps cannot be
+    // renumbered, so any order but the default one is rejected
+    void RequireDefaultOrder();
+    // caches boundaries of 1-cells and frees the complexes and the algorithm
+    void ReleaseComplexes(const CellsByDim& cellsByDim);
 
     InputSComplexPtr    _complex;
     AlgorithmPtr        _algorithm;
+    // boundaries of 1-cells kept after the complexes are released
+    std::map<Id, Chain> _1Boundaries;
     FGLogger            _logger;
+    FGOptions           _options;
 };
 
 #include "AKQReducedSComplexSupplier.hpp"
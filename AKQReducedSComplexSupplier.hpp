@@ -8,28 +8,53 @@
 
 #include "AKQReducedSComplexSupplier.h"
 
+#include <stdexcept>
+
 #include "AKQHomotopicPaths.h"
-#include "SComplexFactory.h"
 #include "HomologyHelpers.h"
+#include "OrderedCoreductions.h"
 
 template <typename Traits>
-AKQReducedSComplexSupplier<Traits>::AKQReducedSComplexSupplier(const char* filename)
+AKQReducedSComplexSupplier<Traits>::AKQReducedSComplexSupplier(const char* filename,
+                                                               const FGOptions& options)
+    : _options(options)
 {
-    _complex = SComplexFactory<InputSComplex>::Load(filename);
+    Dims dims;
+    KappaMap kappaMap;
+    if (SComplexFactory<InputSComplex>::LoadKappaMap(filename, _options._skeletonDim, dims, kappaMap))
+    {
+        CreateAlgorithm(dims, kappaMap);
+        return;
+    }
+    RequireDefaultOrder();
+    _complex = SComplexFactory<InputSComplex>::Load(filename, _options._skeletonDim);
     CreateAlgorithm();
 }
 
 template <typename Traits>
-AKQReducedSComplexSupplier<Traits>::AKQReducedSComplexSupplier(DebugComplexType type)
+AKQReducedSComplexSupplier<Traits>::AKQReducedSComplexSupplier(DebugComplexType type,
+                                                               const FGOptions& options)
+    : _options(options)
 {
+    Dims dims;
+    KappaMap kappaMap;
+    if (SComplexFactory<InputSComplex>::CreateKappaMap(type, dims, kappaMap))
+    {
+        CreateAlgorithm(dims, kappaMap);
+        return;
+    }
+    RequireDefaultOrder();
     _complex = SComplexFactory<InputSComplex>::Create(type);
     CreateAlgorithm();
 }
 
 template <typename Traits>
-AKQReducedSComplexSupplier<Traits>::AKQReducedSComplexSupplier(InputSComplexPtr inputSComplex)
+AKQReducedSComplexSupplier<Traits>::AKQReducedSComplexSupplier(InputSComplexPtr inputSComplex,
+                                                               const FGOptions& options)
     : _complex(inputSComplex)
+    , _options(options)
 {
+    RequireDefaultOrder();
     CreateAlgorithm();
 }
 
@@ -41,16 +66,34 @@ void AKQReducedSComplexSupplier<Traits>::CreateAlgorithm()
     _logger.Log(FGLogger::Details) << "algorithm started" << std::endl;
     size_t reducedCount = (*_algorithm)();
     _logger.Log(FGLogger::Details) << "algorithm ended" << std::endl;
+    int time = _logger.End();
     if (_logger.PrintCoreducedCellsCount())
     {
         _logger.Log(FGLogger::Details)<<"number of reduced pairs: "<<reducedCount<<std::endl;
         _logger.Log(FGLogger::Details)<<"number of extracted cells: "<<_algorithm->getExtractedSignature().size()<<std::endl;
+        _logger.Log(FGLogger::Details)<<"coreductions time: "<<time<<" ms"<<std::endl;
+    }
+}
+
+template <typename Traits>
+void AKQReducedSComplexSupplier<Traits>::CreateAlgorithm(Dims& dims, KappaMap& kappaMap)
+{
+    OrderedCoreductions<InputSComplex, Strategy, Algorithm>::Perform(_options, _logger, dims, kappaMap,
+                                                                     _complex, _algorithm);
+}
+
+template <typename Traits>
+void AKQReducedSComplexSupplier<Traits>::RequireDefaultOrder()
+{
+    if (_options._orderPolicy != OP_Default)
+    {
+        throw std::runtime_error("order of cells can be changed only for complexes given by kappa maps");
     }
 }
 
 template <typename Traits>
 bool AKQReducedSComplexSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
-                                                  std::map<Id, Chain>& _2Boundaries)
+                                                  Chains& _2Boundaries)
 {
     OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
     int maxDim = static_cast<int>(outputComplex->getDim());
@@ -67,26 +110,61 @@ bool AKQReducedSComplexSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
     }
 
     // if there are some 2-cells, take its boundaries
-    AKQHomotopicPaths<AKQReducedSComplexSupplier<Traits> > homotopicPaths(this, _algorithm->getStrategy());
-    _2Boundaries.clear();
+    _2Boundaries.Clear();
     if (cellsByDim.size() > 2)
     {
-        Cells _2cells = cellsByDim[2];
-        typename Cells::iterator it = _2cells.begin();
-        typename Cells::iterator itEnd = _2cells.end();
-        for ( ; it != itEnd; ++it)
+        _logger.Begin(FGLogger::Details, "computing homotopic boundaries");
+        AKQHomotopicPaths<AKQReducedSComplexSupplier<Traits> > homotopicPaths(this, _algorithm->getStrategy());
+        Cells& _2cells = cellsByDim[2];
+        std::vector<Id> cells(_2cells.begin(), _2cells.end());
+        homotopicPaths.GetHomotopicBoundaries(cells, _2Boundaries, _options._threadsCount);
+        _logger.End();
+
+        HomotopicPathsStats stats = homotopicPaths.GetStats();
+        _logger.Log(FGLogger::Details)<<"homotopic paths statistics:"<<std::endl;
+        stats.Print(_logger.Log(FGLogger::Details));
+        if (_options._statsFilename.size() > 0 && !stats.Dump(_options._statsFilename))
         {
-            _2Boundaries[*it] = homotopicPaths.GetHomotopicBoundary(*it);
-            //_2Boundaries[*it] = GetBoundary(*it);
+            _logger.Log(FGLogger::Output)<<"cannot write statistics to "<<_options._statsFilename<<std::endl;
         }
     }
+    if (_options._leanMemory)
+    {
+        ReleaseComplexes(cellsByDim);
+    }
     return cellsByDim.size() > 0;
 }
 
+template <typename Traits>
+void AKQReducedSComplexSupplier<Traits>::ReleaseComplexes(const CellsByDim& cellsByDim)
+{
+    _logger.Begin(FGLogger::Details, "releasing complexes");
+    // only boundaries of 1-cells are needed later (for the spanning tree)
+    if (cellsByDim.size() > 1)
+    {
+        typename Cells::const_iterator it = cellsByDim[1].begin();
+        typename Cells::const_iterator itEnd = cellsByDim[1].end();
+        for ( ; it != itEnd; ++it)
+        {
+            _1Boundaries[*it] = GetBoundary(*it);
+        }
+    }
+    // algorithm (with its strategy and output complex) refers to the input complex
+    _algorithm.reset();
+    _complex.reset();
+    _logger.End();
+}
+
 template <typename Traits>
 typename AKQReducedSComplexSupplier<Traits>::Chain
 AKQReducedSComplexSupplier<Traits>::GetBoundary(const Id& cellId)
 {
+    if (!_algorithm)
+    {
+        typename std::map<Id, Chain>::const_iterator it = _1Boundaries.find(cellId);
+        assert(it != _1Boundaries.end());
+        return it->second;
+    }
     OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
     Cell cell = (*outputComplex)[cellId];
     Chain boundary;
@@ -104,7 +182,7 @@ AKQReducedSComplexSupplier<Traits>::GetBoundary(const Id& cellId)
 
 template <typename Traits>
 template <typename ComplexType>
-std::list<std::pair<typename ComplexType::Id, int> >
+InlineVector<std::pair<typename ComplexType::Id, int>, 4>
 AKQReducedSComplexSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
                                             const typename ComplexType::Id& cellId)
 {
@@ -112,7 +190,7 @@ AKQReducedSComplexSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
     typedef typename ComplexType::Cell Cell;
     typedef typename ComplexType::Iterators::BdCells BdCells;
     Cell cell = (*complex)[cellId];
-    std::list<std::pair<Id, int> > boundary;
+    InlineVector<std::pair<Id, int>, 4> boundary;
     BdCells bdCells = complex->iterators().bdCells(cell);
     typename BdCells::iterator it = bdCells.begin();
     typename BdCells::iterator itEnd = bdCells.end();
@@ -129,6 +207,11 @@ AKQReducedSComplexSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
 template <typename Traits>
 void AKQReducedSComplexSupplier<Traits>::PrintDebug()
 {
+    if (!_algorithm)
+    {
+        _logger.Log(FGLogger::Debug)<<"complexes released"<<std::endl;
+        return;
+    }
     _logger.Log(FGLogger::Debug)<<"extracted signature:"<<std::endl<<_algorithm->getExtractedSignature()<<std::endl;
 
     OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
@@ -0,0 +1,57 @@
+/*
+ * File:   CellsOrder.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef CELLSORDER_H
+#define	CELLSORDER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "FGOptions.h"
+#include "KappaMapBuffer.h"
+
+// Renumbering of cells of a complex given by a kappa map. Coreductions
+// look for aces in the order of cell ids, so this order decides where
+// coreduction sequences start and how many critical cells are left.
+// Cells stay numbered by dimension, the policy orders cells inside
+// every dimension.
+template <typename IdT, typename DimT>
+class CellsOrder
+{
+public:
+
+    typedef IdT                     Id;
+    typedef DimT                    Dim;
+    typedef std::vector<Dim>        Dims;
+    typedef KappaMapBuffer<Id>      KappaMap;
+
+    // seed is used only by OP_Random
+    static void Apply(OrderPolicy policy, unsigned int seed, Dims& dims, KappaMap& kappaMap);
+
+    static const char* GetName(OrderPolicy policy);
+
+private:
+
+    typedef std::vector<size_t>     Keys;
+
+    // orders cells by dimension, then by key, then by original id
+    struct Less
+    {
+        const Dims* dims;
+        const Keys* keys;
+
+        bool operator()(size_t a, size_t b) const;
+    };
+
+    // number of cofaces of every cell
+    static void GetDegrees(const Dims& dims, const KappaMap& kappaMap, Keys& keys);
+    // distance in the face-coface graph from free faces of top cells
+    static void GetBoundaryDistances(const Dims& dims, const KappaMap& kappaMap, Keys& keys);
+    static void GetRandomKeys(unsigned int seed, const Dims& dims, Keys& keys);
+};
+
+#include "CellsOrder.hpp"
+
+#endif	/* CELLSORDER_H */
@@ -0,0 +1,179 @@
+/*
+ * File:   CellsOrder.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef CELLSORDER_HPP
+#define	CELLSORDER_HPP
+
+#include "CellsOrder.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+template <typename IdT, typename DimT>
+bool CellsOrder<IdT, DimT>::Less::operator()(size_t a, size_t b) const
+{
+    if ((*dims)[a] != (*dims)[b])
+    {
+        return (*dims)[a] < (*dims)[b];
+    }
+    if ((*keys)[a] != (*keys)[b])
+    {
+        return (*keys)[a] < (*keys)[b];
+    }
+    return a < b;
+}
+
+template <typename IdT, typename DimT>
+void CellsOrder<IdT, DimT>::Apply(OrderPolicy policy, unsigned int seed, Dims& dims, KappaMap& kappaMap)
+{
+    Keys keys;
+    switch (policy)
+    {
+        case OP_Default:
+            return;
+        case OP_LowestDegree:
+            GetDegrees(dims, kappaMap, keys);
+            break;
+        case OP_BoundaryBFS:
+            GetBoundaryDistances(dims, kappaMap, keys);
+            break;
+        case OP_Random:
+            GetRandomKeys(seed, dims, keys);
+            break;
+        default:
+            throw std::logic_error("not implemented");
+    }
+
+    std::vector<size_t> order(dims.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    Less less = { &dims, &keys };
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<Id> newIds(dims.size());
+    Dims newDims(dims.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        newIds[order[i]] = static_cast<Id>(i);
+        newDims[i] = dims[order[i]];
+    }
+    kappaMap.Renumber(newIds);
+    dims.swap(newDims);
+}
+
+template <typename IdT, typename DimT>
+const char* CellsOrder<IdT, DimT>::GetName(OrderPolicy policy)
+{
+    switch (policy)
+    {
+        case OP_Default:
+            return "default";
+        case OP_LowestDegree:
+            return "lowest degree";
+        case OP_BoundaryBFS:
+            return "boundary BFS";
+        case OP_Random:
+            return "random";
+        default:
+            return "unknown";
+    }
+}
+
+template <typename IdT, typename DimT>
+void CellsOrder<IdT, DimT>::GetDegrees(const Dims& dims, const KappaMap& kappaMap, Keys& keys)
+{
+    keys.assign(dims.size(), 0);
+    for (size_t i = 0; i < kappaMap.Size(); i++)
+    {
+        keys[kappaMap.GetFace(i)]++;
+    }
+}
+
+template <typename IdT, typename DimT>
+void CellsOrder<IdT, DimT>::GetBoundaryDistances(const Dims& dims, const KappaMap& kappaMap, Keys& keys)
+{
+    const size_t unreached = std::numeric_limits<size_t>::max();
+    keys.assign(dims.size(), unreached);
+    if (dims.empty())
+    {
+        return;
+    }
+
+    // face-coface graph in CSR layout
+    std::vector<size_t> offsets(dims.size() + 1, 0);
+    for (size_t i = 0; i < kappaMap.Size(); i++)
+    {
+        offsets[kappaMap.GetCell(i) + 1]++;
+        offsets[kappaMap.GetFace(i) + 1]++;
+    }
+    for (size_t i = 1; i < offsets.size(); i++)
+    {
+        offsets[i] += offsets[i - 1];
+    }
+    std::vector<Id> neighbours(offsets.back());
+    std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < kappaMap.Size(); i++)
+    {
+        neighbours[positions[kappaMap.GetCell(i)]++] = kappaMap.GetFace(i);
+        neighbours[positions[kappaMap.GetFace(i)]++] = kappaMap.GetCell(i);
+    }
+
+    // free faces of top cells are the sources
+    Dim topDim = *std::max_element(dims.begin(), dims.end());
+    std::deque<size_t> queue;
+    for (size_t i = 0; i < dims.size(); i++)
+    {
+        if (topDim == 0 || dims[i] + 1 != topDim)
+        {
+            continue;
+        }
+        size_t cofacesCount = 0;
+        for (size_t j = offsets[i]; j < offsets[i + 1]; j++)
+        {
+            if (dims[neighbours[j]] == topDim)
+            {
+                cofacesCount++;
+            }
+        }
+        if (cofacesCount == 1)
+        {
+            keys[i] = 0;
+            queue.push_back(i);
+        }
+    }
+    while (!queue.empty())
+    {
+        size_t cell = queue.front();
+        queue.pop_front();
+        for (size_t j = offsets[cell]; j < offsets[cell + 1]; j++)
+        {
+            size_t neighbour = neighbours[j];
+            if (keys[neighbour] == unreached)
+            {
+                keys[neighbour] = keys[cell] + 1;
+                queue.push_back(neighbour);
+            }
+        }
+    }
+}
+
+template <typename IdT, typename DimT>
+void CellsOrder<IdT, DimT>::GetRandomKeys(unsigned int seed, const Dims& dims, Keys& keys)
+{
+    keys.resize(dims.size());
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        keys[i] = i;
+    }
+    std::mt19937 generator(seed);
+    std::shuffle(keys.begin(), keys.end(), generator);
+}
+
+#endif	/* CELLSORDER_HPP */
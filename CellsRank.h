@@ -0,0 +1,73 @@
+/*
+ * File:   CellsRank.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef CELLSRANK_H
+#define	CELLSRANK_H
+
+#include <cstddef>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+// Rank of a cell of a cubical cell set among the cells of the same
+// dimension, counted in the bitmap order from the beginning of its slab
+// (a range of the last coordinate). Dimension of a cell is the number of
+// its odd coordinates, so along a row (all coordinates but the first one
+// fixed) cells of two dimensions alternate. Cells are kept as bits of
+// words starting every row, every word knows how many cells of each
+// parity of the first coordinate precede it in the row and every row
+// knows how many cells of its two dimensions precede it in the slab.
+// A lookup is a popcount of one masked word and it takes about 2 bits
+// per bit position instead of an index entry.
+template <int DIM>
+class CellsRank
+{
+public:
+
+    CellsRank();
+
+    // clears the set, widths are the numbers of bit positions of the cell set
+    void Resize(const int* widths);
+    // cells are inserted by iterators of the cell set (or anything with coord(i))
+    template <typename Iterator>
+    void Insert(const Iterator& it);
+    // removes the cells of the slab
+    void Clear(int begin, int end);
+    // counts ranks of the cells of the slab, counts[dim] receives
+    // the number of the cells of every dimension
+    void Build(int begin, int end, std::vector<size_t>& counts);
+    // number of cells of the same dimension before the cell in its slab
+    template <typename Iterator>
+    size_t Rank(const Iterator& it) const;
+
+    void Swap(CellsRank& other);
+    size_t Bytes() const;
+
+private:
+
+    typedef boost::uint64_t     Word;
+
+    enum
+    {
+        WORD_BITS = 64,
+    };
+
+    static const Word EVEN_BITS = 0x5555555555555555ull;
+
+    template <typename Iterator>
+    size_t GetRow(const Iterator& it) const;
+
+    int                         _widths[DIM];
+    size_t                      _wordsPerRow;
+    size_t                      _rowStrides[DIM];
+    std::vector<Word>           _words;
+    // per word (even and odd first coordinate) cells before it in the row
+    std::vector<unsigned int>   _wordRanks;
+    // per row (its even and odd first coordinate) cells before it in the slab
+    std::vector<size_t>         _rowRanks;
+};
+
+#include "CellsRank.hpp"
+
+#endif	/* CELLSRANK_H */
@@ -0,0 +1,139 @@
+/*
+ * File:   CellsRank.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef CELLSRANK_HPP
+#define	CELLSRANK_HPP
+
+#include "CellsRank.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+
+template <int DIM>
+CellsRank<DIM>::CellsRank()
+    : _wordsPerRow(0)
+{
+    std::fill(_widths, _widths + DIM, 0);
+    std::fill(_rowStrides, _rowStrides + DIM, 0);
+}
+
+template <int DIM>
+void CellsRank<DIM>::Resize(const int* widths)
+{
+    // slabs are ranges of the last coordinate, so they consist of whole rows
+    assert(DIM > 1);
+    std::copy(widths, widths + DIM, _widths);
+    _wordsPerRow = (static_cast<size_t>(widths[0]) + WORD_BITS - 1) / WORD_BITS;
+    size_t rowsCount = 1;
+    for (int i = 1; i < DIM; i++)
+    {
+        _rowStrides[i] = rowsCount;
+        rowsCount *= static_cast<size_t>(widths[i]);
+    }
+    _words.assign(rowsCount * _wordsPerRow, 0);
+    _wordRanks.assign(2 * rowsCount * _wordsPerRow, 0);
+    _rowRanks.assign(2 * rowsCount, 0);
+}
+
+template <int DIM>
+template <typename Iterator>
+void CellsRank<DIM>::Insert(const Iterator& it)
+{
+    size_t x = static_cast<size_t>(it.coord(0));
+    size_t word = GetRow(it) * _wordsPerRow + x / WORD_BITS;
+    assert(word < _words.size());
+    _words[word] |= Word(1) << (x % WORD_BITS);
+}
+
+template <int DIM>
+void CellsRank<DIM>::Clear(int begin, int end)
+{
+    size_t rowsPerSlice = _rowStrides[DIM - 1];
+    std::fill(_words.begin() + begin * rowsPerSlice * _wordsPerRow,
+              _words.begin() + end * rowsPerSlice * _wordsPerRow, 0);
+}
+
+template <int DIM>
+void CellsRank<DIM>::Build(int begin, int end, std::vector<size_t>& counts)
+{
+    counts.assign(DIM + 1, 0);
+    size_t rowsPerSlice = _rowStrides[DIM - 1];
+    size_t rowsEnd = end * rowsPerSlice;
+    for (size_t row = begin * rowsPerSlice; row < rowsEnd; row++)
+    {
+        // dimensions of the cells of the row are given by the parity
+        // of its coordinates (and of the first one)
+        int oddCount = 0;
+        for (int i = 1; i < DIM; i++)
+        {
+            oddCount += static_cast<int>((row / _rowStrides[i]) % _widths[i]) & 1;
+        }
+        _rowRanks[2 * row] = counts[oddCount];
+        _rowRanks[2 * row + 1] = counts[oddCount + 1];
+
+        unsigned int evenCount = 0;
+        unsigned int oddXCount = 0;
+        size_t wordsEnd = (row + 1) * _wordsPerRow;
+        for (size_t word = row * _wordsPerRow; word < wordsEnd; word++)
+        {
+            _wordRanks[2 * word] = evenCount;
+            _wordRanks[2 * word + 1] = oddXCount;
+            evenCount += static_cast<unsigned int>(std::bitset<WORD_BITS>(_words[word] & EVEN_BITS).count());
+            oddXCount += static_cast<unsigned int>(std::bitset<WORD_BITS>(_words[word] & ~EVEN_BITS).count());
+        }
+        counts[oddCount] += evenCount;
+        counts[oddCount + 1] += oddXCount;
+    }
+}
+
+template <int DIM>
+template <typename Iterator>
+size_t CellsRank<DIM>::Rank(const Iterator& it) const
+{
+    size_t x = static_cast<size_t>(it.coord(0));
+    size_t row = GetRow(it);
+    size_t word = row * _wordsPerRow + x / WORD_BITS;
+    size_t parity = x & 1;
+    Word mask = (parity ? ~EVEN_BITS : EVEN_BITS) & ((Word(1) << (x % WORD_BITS)) - 1);
+    assert(_words[word] & (Word(1) << (x % WORD_BITS)));
+    return _rowRanks[2 * row + parity] + _wordRanks[2 * word + parity]
+           + std::bitset<WORD_BITS>(_words[word] & mask).count();
+}
+
+template <int DIM>
+void CellsRank<DIM>::Swap(CellsRank& other)
+{
+    std::swap(_wordsPerRow, other._wordsPerRow);
+    for (int i = 0; i < DIM; i++)
+    {
+        std::swap(_widths[i], other._widths[i]);
+        std::swap(_rowStrides[i], other._rowStrides[i]);
+    }
+    _words.swap(other._words);
+    _wordRanks.swap(other._wordRanks);
+    _rowRanks.swap(other._rowRanks);
+}
+
+template <int DIM>
+size_t CellsRank<DIM>::Bytes() const
+{
+    return _words.capacity() * sizeof(Word) + _wordRanks.capacity() * sizeof(unsigned int)
+           + _rowRanks.capacity() * sizeof(size_t);
+}
+
+template <int DIM>
+template <typename Iterator>
+size_t CellsRank<DIM>::GetRow(const Iterator& it) const
+{
+    size_t row = 0;
+    for (int i = 1; i < DIM; i++)
+    {
+        row += static_cast<size_t>(it.coord(i)) * _rowStrides[i];
+    }
+    return row;
+}
+
+#endif	/* CELLSRANK_HPP */
@@ -6,28 +6,24 @@
 #ifndef COLLAPSEDAKQREDUCEDCUBSCOMPLEXSUPPLIER_H
 #define	COLLAPSEDAKQREDUCEDCUBSCOMPLEXSUPPLIER_H
 
-#include <map>
-#include <set>
 #include <vector>
 #include <boost/shared_ptr.hpp>
-#include <capd/complex/Coreduction.h>
 
+#include "CellsRank.h"
+#include "CubSetReductionsLog.h"
 #include "DebugComplexType.h"
-#include "FGLogger.h"
+#include "FGOptions.h"
+#include "GrayscaleVolume.h"
+#include "QuotientAKQSupplier.h"
 
 template <typename Traits>
-class CollapsedAKQReducedCubSComplexSupplier
+class CollapsedAKQReducedCubSComplexSupplier : public QuotientAKQSupplier<Traits>
 {
 public:
 
-    typedef typename Traits::GeneralSComplexType    InputSComplex;
-    typedef typename Traits::GeneralSComplexType    OutputSComplex;
-
     typedef typename Traits::SComplexType           CubSComplex;
     typedef boost::shared_ptr<CubSComplex>          CubSComplexPtr;
 
-    typedef typename Traits::ScalarType             Scalar;
-
 private:
 
     typedef typename Traits::CubCoordType           Coord;
@@ -40,79 +36,158 @@ private:
         DIM = Traits::DIM,
     };
 
-    typedef boost::shared_ptr<InputSComplex>        InputSComplexPtr;
-    typedef typename Traits::IntType                Int;
-
-    typedef typename InputSComplex::Dim             Dim;
-    typedef typename InputSComplex::Dims            Dims;
-    typedef typename InputSComplex::KappaMap        KappaMap;
-    typedef typename InputSComplex::KappaMapEntry   KappaMapEntry;
-    typedef typename OutputSComplex::Iterators::DimCells DimCells;
-    typedef typename OutputSComplex::Iterators::BdCells  BdCells;
-
-    typedef AKQReduceStrategy<InputSComplex, OutputSComplex, Scalar> Strategy;
-    typedef Coreduction<Strategy, Scalar, Int>      Algorithm;
-    typedef boost::shared_ptr<Algorithm>            AlgorithmPtr;
+    typedef QuotientAKQSupplier<Traits>             Base;
+    typedef typename Base::Dims                     Dims;
+    typedef typename Base::KappaMap                 KappaMap;
 
 public:
 
-    typedef Traits                                  HomologyTraits;
-    typedef typename InputSComplex::Id              Id;
-    typedef typename OutputSComplex::Cell           Cell;
-    typedef std::set<Id>                            Cells;
-    typedef std::vector<Cells>                      CellsByDim;
-    typedef std::vector<std::pair<Id, int> >        Chain;
+    typedef typename Base::Id                       Id;
+    typedef typename Base::Cell                     Cell;
+    typedef typename Base::Chain                    Chain;
 
-    CollapsedAKQReducedCubSComplexSupplier(const char* filename);
-    CollapsedAKQReducedCubSComplexSupplier(DebugComplexType type);
-    CollapsedAKQReducedCubSComplexSupplier(CubSComplexPtr cubSComplex);
-
-    bool GetCells(CellsByDim& cellsByDim, std::map<Id, Chain>& _2Boundaries);
-    Chain GetBoundary(const Id& cellId);
-
-    template <typename ComplexType>
-    std::list<std::pair<typename ComplexType::Id, int> >
-    GetOrdered2Boundary(ComplexType* complex, const typename ComplexType::Id& cellId);
+    // work done by the last Update
+    struct UpdateStats
+    {
+        // cubes which entered or left the shaved set or its acyclic subset
+        size_t  _changedCubes;
+        // slabs of the quotient with changed cells and slabs emitted again
+        size_t  _countedSlabs;
+        size_t  _emittedSlabs;
+        size_t  _slabsCount;
+
+        UpdateStats()
+            : _changedCubes(0)
+            , _countedSlabs(0)
+            , _emittedSlabs(0)
+            , _slabsCount(0)
+        {}
+    };
 
-    void PrintDebug();
+    CollapsedAKQReducedCubSComplexSupplier(const char* filename, const FGOptions& options = FGOptions());
+    CollapsedAKQReducedCubSComplexSupplier(DebugComplexType type, const FGOptions& options = FGOptions());
+    CollapsedAKQReducedCubSComplexSupplier(CubSComplexPtr cubSComplex, const FGOptions& options = FGOptions());
+
+    // editing of the input set (only with FGOptions::_editable), coords are
+    // given in the input coordinates; false is returned if the cube lies
+    // outside the bounds of the input
+    bool InsertCube(const int* coords);
+    bool RemoveCube(const int* coords);
+    bool HasCube(const int* coords);
+    // updates the complex if the input set has changed since the last
+    // computation (returns false otherwise), GetCells gives new cells then;
+    // only the steps of shaving and of the acyclic subspace next to the
+    // edits are redone and only the slabs of the quotient kappa-map with
+    // changed cells (and their neighbours) are emitted again, coreductions
+    // are performed on the whole quotient
+    bool Update();
+    const UpdateStats& GetUpdateStats() const;
+    // edits the input set of a grayscale input (only with
+    // FGOptions::_editable) to the sublevel set of the threshold,
+    // only voxels between the old and the new threshold are visited
+    void SetThreshold(int threshold);
 
 private:
 
+    using Base::CreateAlgorithm;
+    using Base::_complex;
+    using Base::_algorithm;
+    using Base::_1Boundaries;
+    using Base::_logger;
+    using Base::_options;
+
+    typedef boost::shared_ptr<CubSet>               InputCubSetPtr;
+    typedef boost::shared_ptr<CubCellSet>           QuotientCubCellSetPtr;
+    typedef CubSetReductionsLog<CubSet>             ReductionsLog;
+    typedef typename ReductionsLog::Positions       Positions;
+    typedef GrayscaleVolume<unsigned short>         Volume;
+    typedef boost::shared_ptr<Volume>               VolumePtr;
+
+    CubSetPtr LoadVolume(const char* filename);
+    static typename Volume::Value GetThresholdValue(int threshold);
+    // keeps the copy of the input set and reduces it with the log (if
+    // editable), shaves the set otherwise
+    void KeepInputCubSet(CubSetPtr cubSet);
+    // false if the cube lies outside the bounds (or in the empty collar)
+    bool GetSetCoords(const int* coords, int* setCoords);
+    bool SetCube(const int* coords, bool value);
     void CreateComplex(CubSetPtr cubSet);
-    void CreateAlgorithm();
+    CubCellSetPtr CreateQuotientCubCellSet(CubSetPtr cubSet);
+    // cubSet is the difference of the shaved set and its acyclic subset
+    CubCellSet* CreateDifferenceCubCellSet(CubSet& cubSet, CubSet& acyclicCubSet);
+    void RemoveCubes(CubSet& cubSet, CubSet& removedCubSet);
+    void RestrictToNeighbourhood(CubSet& acyclicCubSet, CubSet& cubSet);
+    bool HasNeighbour(CubSet& cubSet, const int* coords, const int* widths);
+    void RemoveClosures(CubCellSet& cubCellSet, CubSet& cubSet);
+    template <typename Iterator>
+    static void NextCoords(Iterator& it, int* coords, const int* widths);
     Chain GetOriginalHomotopicBoundary(const Cell& cell);
 
-    InputSComplexPtr    _complex;
-    AlgorithmPtr        _algorithm;
-    FGLogger            _logger;
+    // editable input set and input coordinates of its cube (0, ..., 0)
+    InputCubSetPtr      _inputCubSet;
+    std::vector<Coord>  _origin;
+    // positions of the cubes edited since the last computation
+    Positions           _editedCubes;
+    // shaving and acyclic subspace of the editable input set
+    ReductionsLog       _reductionsLog;
+    // quotient of the editable input set (kept with its slabs)
+    QuotientCubCellSetPtr _quotientCubCellSet;
+    UpdateStats         _updateStats;
+    // grayscale input (kept only if editable) and its current threshold
+    VolumePtr           _volume;
+    typename Volume::Value _threshold;
 
     typedef typename CubCellSet::BitCoordIterator   BitCoordIterator;
     typedef typename CubCellSet::PointCoordIterator PointCoordIterator;
-    struct CellDescriptor
+
+    enum
     {
-        size_t                          _index;
-        size_t                          _dim;
-        std::vector<CellDescriptor*>    _faces;
-        std::vector<int>                _coefficients;
-
-        CellDescriptor(size_t index, size_t dim)
-            : _index(index)
-            , _dim(dim)
-        {}
+        // width of the slabs of an editable input (in CubCellSet coordinates)
+        EDITABLE_SLAB_WIDTH = 16,
     };
 
-    typedef std::vector<CellDescriptor*>                CellsDescriptors;
-    typedef std::map<BitCoordIterator, CellDescriptor*> CellsMap;
-    typedef std::map<size_t, CellsMap>                  CellsMapByDim;
-
-    CellDescriptor                                      *_nullSetCell;
-    CellsDescriptors                                    _allCells;
-    CellsMapByDim                                       _cellsMapByDim;
-    std::map<size_t, size_t>                            _cellsCountByDim;
+    // part of CubCellSet between two values of the last coordinate (i.e.
+    // a contiguous range of bits), every cell belongs to the slab of its bit
+    struct Slab
+    {
+        int                     _begin;
+        int                     _end;
+        // number of cells and id of the first cell of each dimension
+        std::vector<size_t>     _cellsCount;
+        std::vector<size_t>     _offsets;
+        // kappa-map entries of the cells of each dimension
+        std::vector<KappaMap>   _kappaMaps;
+    };
 
-    void CreateKappaMapFromQuotient(CubCellSetPtr cubCellSet, Dims& dims, KappaMap& kappaMap);
-    CellDescriptor* AddCell(CubCellSetPtr cubCellSet, BitCoordIterator& it, size_t dim);
-    CellDescriptor* CreateCell(CubCellSetPtr cubCellSet, BitCoordIterator& it, size_t dim);
+    // index of the cell within its slab and dimension
+    CellsRank<DIM>                                      _cellsRank;
+    std::vector<Slab>                                   _slabs;
+    int                                                 _slabWidth;
+
+    typedef void (CollapsedAKQReducedCubSComplexSupplier::*SlabMethod)(CubCellSet*, Slab*);
+
+    void CreateKappaMapFromQuotient(CubCellSet& cubCellSet, Dims& dims, KappaMap& kappaMap);
+    // changed are positions of the cubes of the input set, countedSlabs
+    // receives true for the slabs with changed cells
+    void UpdateQuotientCubCellSet(const Positions& changed, std::vector<bool>& countedSlabs);
+    bool IsQuotientCell(const int* cellCoords);
+    void UpdateKappaMap(const std::vector<bool>& countedSlabs, Dims& dims, KappaMap& kappaMap);
+    void CreateSlabs(CubCellSet& cubCellSet);
+    int GetThreadsCount() const;
+    // runs the method for the selected slabs in parallel
+    void ForEachSlab(SlabMethod method, CubCellSet& cubCellSet, const std::vector<bool>& selected);
+    void RunSlabs(SlabMethod method, CubCellSet* cubCellSet, const std::vector<bool>* selected,
+                  int thread, int threadsCount);
+    void CountSlabCells(CubCellSet* cubCellSet, Slab* slab);
+    void EmitSlabCells(CubCellSet* cubCellSet, Slab* slab);
+    // sets ids of the first cells of the slabs, returns the number of ids
+    size_t SetOffsets();
+    void GetOffsets(std::vector<Id>& offsets) const;
+    void FillDims(size_t cellsCount, Dims& dims) const;
+    void ConcatenateSlabs(KappaMap& kappaMap, bool keepSlabs);
+    void GetFaces(CubCellSet& cubCellSet, BitCoordIterator& it, size_t dim,
+                  std::vector<BitCoordIterator>& faces, std::vector<int>& coefficients);
+    Id GetCellId(const BitCoordIterator& it, size_t dim) const;
 };
 
 #include "CollapsedAKQReducedCubSComplexSupplier.hpp"
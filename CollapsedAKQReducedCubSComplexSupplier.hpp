@@ -8,39 +8,272 @@
 
 #include "CollapsedAKQReducedCubSComplexSupplier.h"
 
-#include "AKQHomotopicPaths.h"
 #include "CubSetFactory.h"
 #include "SComplexFactory.h"
 #include <capd/cubSet/CubSetT.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
 
 template <typename Traits>
-CollapsedAKQReducedCubSComplexSupplier<Traits>::CollapsedAKQReducedCubSComplexSupplier(const char* filename)
+CollapsedAKQReducedCubSComplexSupplier<Traits>::CollapsedAKQReducedCubSComplexSupplier(const char* filename,
+                                                                                       const FGOptions& options)
+    : Base(options)
+    , _threshold(0)
 {
-    CubSetPtr cubSet = CubSetFactory<CubSet>::Load(filename, true);
+    CubSetPtr cubSet = Volume::IsVolumeFile(filename) ? LoadVolume(filename)
+                                                      : CubSetFactory<CubSet>::Load(filename, false, _origin);
+    KeepInputCubSet(cubSet);
     CreateComplex(cubSet);
-    CreateAlgorithm();
 }
 
 template <typename Traits>
-CollapsedAKQReducedCubSComplexSupplier<Traits>::CollapsedAKQReducedCubSComplexSupplier(DebugComplexType type)
+CollapsedAKQReducedCubSComplexSupplier<Traits>::CollapsedAKQReducedCubSComplexSupplier(DebugComplexType type,
+                                                                                       const FGOptions& options)
+    : Base(options)
+    , _threshold(0)
 {
-    CubSetPtr cubSet = CubSetFactory<CubSet>::Create(type, true);
+    CubSetPtr cubSet = CubSetFactory<CubSet>::Create(type, false, _origin);
+    KeepInputCubSet(cubSet);
     CreateComplex(cubSet);
-    CreateAlgorithm();
 }
 
 template <typename Traits>
-CollapsedAKQReducedCubSComplexSupplier<Traits>::CollapsedAKQReducedCubSComplexSupplier(CubSComplexPtr cubSComplex)
+CollapsedAKQReducedCubSComplexSupplier<Traits>::CollapsedAKQReducedCubSComplexSupplier(CubSComplexPtr cubSComplex,
+                                                                                       const FGOptions& options)
+    : Base(options)
+    , _origin(DIM, 0)
+    , _threshold(0)
 {
     _logger.Begin(FGLogger::Details, "converting CubCellSet -> CubSet");
-    CubSetPtr cubSet = CubSetFactory<CubSet>::ConvertCubCellSet(cubSComplex->getCubCellSet(), true);
+    CubSetPtr cubSet = CubSetFactory<CubSet>::ConvertCubCellSet(cubSComplex->getCubCellSet(), false);
     _logger.End();
+    KeepInputCubSet(cubSet);
     CreateComplex(cubSet);
-    CreateAlgorithm();
+}
+
+template <typename Traits>
+typename CollapsedAKQReducedCubSComplexSupplier<Traits>::CubSetPtr
+CollapsedAKQReducedCubSComplexSupplier<Traits>::LoadVolume(const char* filename)
+{
+    if (_options._thresholds.empty())
+    {
+        throw std::runtime_error("threshold is required for grayscale input");
+    }
+    VolumePtr volume = VolumePtr(new Volume());
+    volume->Load(filename);
+    _threshold = GetThresholdValue(_options._thresholds[0]);
+    CubSetPtr cubSet = CubSetFactory<CubSet>::Create(*volume, _threshold, false, _origin);
+    if (_options._editable)
+    {
+        // voxels of other levels are taken from the volume sorted by value
+        volume->SortByValue();
+        _volume = volume;
+    }
+    return cubSet;
+}
+
+template <typename Traits>
+typename CollapsedAKQReducedCubSComplexSupplier<Traits>::Volume::Value
+CollapsedAKQReducedCubSComplexSupplier<Traits>::GetThresholdValue(int threshold)
+{
+    if (threshold < 0 || threshold > std::numeric_limits<typename Volume::Value>::max())
+    {
+        throw std::runtime_error("threshold out of range");
+    }
+    return static_cast<typename Volume::Value>(threshold);
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::SetThreshold(int threshold)
+{
+    if (!_volume || !_inputCubSet)
+    {
+        throw std::logic_error("input is not an editable grayscale volume");
+    }
+    typename Volume::Value value = GetThresholdValue(threshold);
+    if (value == _threshold)
+    {
+        return;
+    }
+    // raising the threshold only adds cubes, lowering only removes them,
+    // only voxels between the thresholds are visited and the edits are
+    // given to the log, so Update starts from the shaved set of the last
+    // level and redoes only the steps next to the edited cubes
+    bool insert = value > _threshold;
+    typename Volume::Voxels::const_iterator it;
+    typename Volume::Voxels::const_iterator itEnd;
+    _volume->GetLevelVoxels(std::min(value, _threshold), std::max(value, _threshold), it, itEnd);
+    int coords[DIM];
+    for ( ; it != itEnd; ++it)
+    {
+        size_t voxel = *it;
+        for (int dim = 0; dim < DIM; dim++)
+        {
+            coords[dim] = static_cast<int>(voxel % _volume->GetSize(dim));
+            voxel /= _volume->GetSize(dim);
+        }
+        SetCube(coords, insert);
+    }
+    _threshold = value;
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::KeepInputCubSet(CubSetPtr cubSet)
+{
+    if (_options._editable)
+    {
+        // the log keeps its own shaved set, so that only its steps next
+        // to the edits are redone
+        _inputCubSet = InputCubSetPtr(new CubSet(cubSet()));
+        _reductionsLog.Reduce(*_inputCubSet);
+    }
+    else
+    {
+        CubSetFactory<CubSet>::Shave(cubSet());
+    }
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::InsertCube(const int* coords)
+{
+    return SetCube(coords, true);
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::RemoveCube(const int* coords)
+{
+    return SetCube(coords, false);
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::HasCube(const int* coords)
+{
+    int setCoords[DIM];
+    return GetSetCoords(coords, setCoords)
+           && typename CubSet::BitIterator(*_inputCubSet, setCoords).getBit();
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::GetSetCoords(const int* coords, int* setCoords)
+{
+    if (!_inputCubSet)
+    {
+        throw std::logic_error("input set is not editable");
+    }
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        setCoords[dim] = coords[dim] - _origin[dim];
+        // the empty collar has to stay empty
+        if (setCoords[dim] < 1 || setCoords[dim] >= _inputCubSet->getUnpaddedWidth(dim) - 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::SetCube(const int* coords, bool value)
+{
+    typedef typename CubSet::BitIterator Iterator;
+    int setCoords[DIM];
+    if (!GetSetCoords(coords, setCoords))
+    {
+        return false;
+    }
+    Iterator it = Iterator(*_inputCubSet, setCoords);
+    if (it.getBit() != value)
+    {
+        if (value)
+        {
+            it.setBit();
+        }
+        else
+        {
+            it.clearBit();
+        }
+        _editedCubes.push_back(_reductionsLog.GetPosition(setCoords));
+    }
+    return true;
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::Update()
+{
+    if (_editedCubes.empty())
+    {
+        return false;
+    }
+    _logger.Begin(FGLogger::Details, "updating edited complex");
+    // algorithm refers to the complex, so it is released first
+    _algorithm.reset();
+    _complex.reset();
+    _1Boundaries.clear();
+
+    _logger.Begin(FGLogger::Details, "updating shaved set and acyclic subspace");
+    Positions changedCubes;
+    _reductionsLog.Update(_editedCubes, changedCubes);
+    _editedCubes.clear();
+    _logger.End();
+
+    _logger.Begin(FGLogger::Details, "updating kappa-map for quotient space");
+    std::vector<bool> countedSlabs(_slabs.size(), false);
+    UpdateQuotientCubCellSet(changedCubes, countedSlabs);
+    Dims dims;
+    KappaMap kappaMap;
+    UpdateKappaMap(countedSlabs, dims, kappaMap);
+    _logger.End();
+    _updateStats._changedCubes = changedCubes.size();
+
+    CreateAlgorithm(dims, kappaMap);
+    _logger.End();
+    return true;
+}
+
+template <typename Traits>
+const typename CollapsedAKQReducedCubSComplexSupplier<Traits>::UpdateStats&
+CollapsedAKQReducedCubSComplexSupplier<Traits>::GetUpdateStats() const
+{
+    return _updateStats;
 }
 
 template <typename Traits>
 void CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateComplex(CubSetPtr cubSet)
+{
+    Dims dims;
+    KappaMap kappaMap;
+    if (_inputCubSet)
+    {
+        // quotient of the shaved set and the acyclic subset of the log,
+        // kept so that only its cells next to the edits are updated
+        CubSet differenceCubSet(_reductionsLog.GetShavedCubSet());
+        CubSet acyclicCubSubset(_reductionsLog.GetAcyclicCubSet());
+        RemoveCubes(differenceCubSet, acyclicCubSubset);
+        _quotientCubCellSet = QuotientCubCellSetPtr(CreateDifferenceCubCellSet(differenceCubSet,
+                                                                              acyclicCubSubset));
+
+        _logger.Begin(FGLogger::Details, "creating kappa-map for quotient space");
+        CreateKappaMapFromQuotient(*_quotientCubCellSet, dims, kappaMap);
+        _logger.End();
+    }
+    else
+    {
+        // quotient CubCellSet is released before the complex is created
+        CubCellSetPtr cubCellSet = CreateQuotientCubCellSet(cubSet);
+
+        _logger.Begin(FGLogger::Details, "creating kappa-map for quotient space");
+        CreateKappaMapFromQuotient(cubCellSet(), dims, kappaMap);
+        _logger.End();
+    }
+
+    CreateAlgorithm(dims, kappaMap);
+}
+
+template <typename Traits>
+typename CollapsedAKQReducedCubSComplexSupplier<Traits>::CubCellSetPtr
+CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateQuotientCubCellSet(CubSetPtr cubSet)
 {
     _logger.Begin(FGLogger::Details, "computing acyclic subspace");
 
@@ -60,274 +293,609 @@ void CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateComplex(CubSetPtr cub
     _logger.Log(FGLogger::Details)<<"computed acyclic subset size: "<<acyclicCubSubset.cardinality()<<std::endl;
     _logger.Log(FGLogger::Details)<<"cubes left: "<<cubSet().cardinality()<<std::endl;
 
+    // the copy of acyclic subset is released here, before the kappa-map is built
+    return CubCellSetPtr(CreateDifferenceCubCellSet(cubSet(), acyclicCubSubset));
+}
+
+template <typename Traits>
+typename CollapsedAKQReducedCubSComplexSupplier<Traits>::CubCellSet*
+CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateDifferenceCubCellSet(CubSet& cubSet,
+                                                                           CubSet& acyclicCubSet)
+{
     _logger.Begin(FGLogger::Details, "computing acyclic subspace intersection with neighbourhood");
-    // creating wrap of "non-reduced"
-    CubSet wrapped(cubSet());
-    wrapped.wrap();
     // important are only these cubes in the acyclic subset, which intersect the difference
-    acyclicCubSubset *= wrapped;
+    // (checked in place instead of intersecting with a wrapped copy of the difference)
+    RestrictToNeighbourhood(acyclicCubSet, cubSet);
     // adding acyclic subspace to original set
-    cubSet() += acyclicCubSubset;
+    cubSet += acyclicCubSet;
     _logger.End();
 
     _logger.Begin(FGLogger::Details, "constructing CubCellSet of the difference");
-    // constructing CubCellSets for each CubSet and computing the difference
-    CubCellSetPtr cubCellSet(new CubCellSet(cubSet()));
-    CubCellSet acyclicCubCellSubset(acyclicCubSubset);
-    cubCellSet() -= acyclicCubCellSubset;
+    // closures of the acyclic cubes are cleared in place
+    // instead of subtracting CubCellSet of the acyclic subset
+    CubCellSet* cubCellSet = new CubCellSet(cubSet);
+    RemoveClosures(*cubCellSet, acyclicCubSet);
     _logger.End();
+    return cubCellSet;
+}
 
-    _logger.Begin(FGLogger::Details, "creating kappa-map for quotient space");
-    Dims dims;
-    KappaMap kappaMap;
-    CreateKappaMapFromQuotient(cubCellSet, dims, kappaMap);
-    _logger.End();
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::RemoveCubes(CubSet& cubSet, CubSet& removedCubSet)
+{
+    typedef typename CubSet::BitIterator Iterator;
+    int widths[DIM];
+    int coords[DIM];
+    size_t totalCount = 1;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        widths[dim] = cubSet.getUnpaddedWidth(dim);
+        coords[dim] = 0;
+        totalCount *= widths[dim];
+    }
 
-    _logger.Begin(FGLogger::Details, "creating SComplex from kappa-map");
-    _complex = SComplexFactory<InputSComplex>::Create(dims, kappaMap);
-    _logger.End();
+    Iterator it = Iterator(removedCubSet, coords);
+    for (size_t i = 0; i < totalCount; i++)
+    {
+        if (it.getBit())
+        {
+            Iterator(cubSet, coords).clearBit();
+        }
+        NextCoords(it, coords, widths);
+    }
 }
 
 template <typename Traits>
-void CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateAlgorithm()
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::RestrictToNeighbourhood(CubSet& acyclicCubSet,
+                                                                             CubSet& cubSet)
 {
-    _logger.Begin(FGLogger::Details, "performing coreductions");
-    _algorithm = AlgorithmPtr(new Algorithm(new Strategy(*_complex)));
-    size_t reducedCount = (*_algorithm)();
-    _logger.End("coreductions finished");
-    if (_logger.PrintCoreducedCellsCount())
+    typedef typename CubSet::BitIterator Iterator;
+    int widths[DIM];
+    int coords[DIM];
+    size_t totalCount = 1;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        widths[dim] = cubSet.getUnpaddedWidth(dim);
+        coords[dim] = 0;
+        totalCount *= widths[dim];
+    }
+
+    Iterator it = Iterator(acyclicCubSet, coords);
+    for (size_t i = 0; i < totalCount; i++)
     {
-        _logger.Log(FGLogger::Details)<<"number of reduced pairs: "<<reducedCount<<std::endl;
-        _logger.Log(FGLogger::Details)<<"number of extracted cells: "<<_algorithm->getExtractedSignature().size()<<std::endl;
+        if (it.getBit() && !HasNeighbour(cubSet, coords, widths))
+        {
+            it.clearBit();
+        }
+        NextCoords(it, coords, widths);
     }
 }
 
 template <typename Traits>
-bool CollapsedAKQReducedCubSComplexSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
-                                                         std::map<Id, Chain>& _2Boundaries)
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::HasNeighbour(CubSet& cubSet,
+                                                                  const int* coords,
+                                                                  const int* widths)
 {
-    OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
-    int maxDim = static_cast<int>(outputComplex->getDim());
-    cellsByDim.resize(maxDim + 1);
-    for (int dim = 0; dim <= maxDim; dim++)
+    typedef typename CubSet::BitIterator Iterator;
+    // neighbourhood of a cube consists of 3^DIM cubes (including itself)
+    int neighboursCount = 1;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        neighboursCount *= 3;
+    }
+    int neighbourCoords[DIM];
+    for (int k = 0; k < neighboursCount; k++)
     {
-        DimCells dimCells = outputComplex->iterators().dimCells(static_cast<Dim>(dim));
-        typename DimCells::iterator it = dimCells.begin();
-        typename DimCells::iterator itEnd = dimCells.end();
-        for ( ; it != itEnd; ++it)
+        bool inside = true;
+        int code = k;
+        for (int dim = 0; dim < DIM; dim++)
         {
-            cellsByDim[dim].insert(it->getId());
+            neighbourCoords[dim] = coords[dim] + code % 3 - 1;
+            code /= 3;
+            inside = inside && neighbourCoords[dim] >= 0 && neighbourCoords[dim] < widths[dim];
+        }
+        if (inside && Iterator(cubSet, neighbourCoords).getBit())
+        {
+            return true;
         }
     }
+    return false;
+}
 
-    // if there are some 2-cells, take its (homotopic) boundaries
-    AKQHomotopicPaths<CollapsedAKQReducedCubSComplexSupplier<Traits> > homotopicPaths(this, _algorithm->getStrategy());
-    _2Boundaries.clear();
-    if (cellsByDim.size() > 2)
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::RemoveClosures(CubCellSet& cubCellSet,
+                                                                    CubSet& cubSet)
+{
+    typedef typename CubSet::BitIterator Iterator;
+    typedef typename CubCellSet::BitIterator CellIterator;
+    int widths[DIM];
+    int coords[DIM];
+    size_t totalCount = 1;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        widths[dim] = cubSet.getUnpaddedWidth(dim);
+        coords[dim] = 0;
+        totalCount *= widths[dim];
+    }
+    int closureCount = 1;
+    for (int dim = 0; dim < DIM; dim++)
     {
-        Cells _2cells = cellsByDim[2];
-        typename Cells::iterator it = _2cells.begin();
-        typename Cells::iterator itEnd = _2cells.end();
-        for ( ; it != itEnd; ++it)
+        closureCount *= 3;
+    }
+
+    Iterator it = Iterator(cubSet, coords);
+    int cellCoords[DIM];
+    for (size_t i = 0; i < totalCount; i++)
+    {
+        if (it.getBit())
         {
-            _2Boundaries[*it] = homotopicPaths.GetHomotopicBoundary(*it);
-        //    _2Boundaries[*it] = GetBoundary(*it);
+            // CubCellSet full cubes are stored at position
+            // [2 * x_i + 1, ... ] where [x_i, ... ] are its actual coords,
+            // its faces differ by -1, 0 or 1 in each coordinate
+            for (int k = 0; k < closureCount; k++)
+            {
+                int code = k;
+                for (int dim = 0; dim < DIM; dim++)
+                {
+                    cellCoords[dim] = 2 * coords[dim] + code % 3;
+                    code /= 3;
+                }
+                CellIterator(cubCellSet, cellCoords).clearBit();
+            }
         }
+        NextCoords(it, coords, widths);
     }
-    return cellsByDim.size() > 0;
 }
 
 template <typename Traits>
-typename CollapsedAKQReducedCubSComplexSupplier<Traits>::Chain
-CollapsedAKQReducedCubSComplexSupplier<Traits>::GetBoundary(const Id& cellId)
+template <typename Iterator>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::NextCoords(Iterator& it, int* coords, const int* widths)
 {
-    OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
-    Cell cell = (*outputComplex)[cellId];
-    Chain boundary;
-    BdCells bdCells = outputComplex->iterators().bdCells(cell);
-    typename BdCells::iterator it = bdCells.begin();
-    typename BdCells::iterator itEnd = bdCells.end();
-    for ( ; it != itEnd; ++it)
+    int dim = 0;
+    bool ok = false;
+    while (!ok && dim < DIM)
     {
-        int ci = outputComplex->coincidenceIndex(cell, *it);
-        assert(ci != 0);
-        boundary.push_back(std::pair<Id, int>(it->getId(), ci));
+        coords[dim]++;
+        it.incInDir(dim);
+        if (coords[dim] < widths[dim])
+        {
+            ok = true;
+        }
+        else
+        {
+            it.decInDir(dim, widths[dim]);
+            coords[dim] = 0;
+            dim++;
+        }
     }
-    return boundary;
 }
 
 template <typename Traits>
-template <typename ComplexType>
-std::list<std::pair<typename ComplexType::Id, int> >
-CollapsedAKQReducedCubSComplexSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
-                                            const typename ComplexType::Id& cellId)
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateKappaMapFromQuotient(CubCellSet& cubCellSet,
+                                                                                 Dims& dims,
+                                                                                 KappaMap& kappaMap)
 {
-    typedef typename ComplexType::Id Id;
-    typedef typename ComplexType::Cell Cell;
-    typedef typename ComplexType::Iterators::BdCells BdCells;
-    Cell cell = (*complex)[cellId];
-    std::list<std::pair<Id, int> > boundary;
-    BdCells bdCells = complex->iterators().bdCells(cell);
-    typename BdCells::iterator it = bdCells.begin();
-    typename BdCells::iterator itEnd = bdCells.end();
-    for( ; it != itEnd; ++it)
+    size_t maxDim = static_cast<size_t>(cubCellSet.embDim());
+    assert(maxDim == DIM);
+    int widths[DIM];
+    for (size_t i = 0; i < maxDim; i++)
+    {
+        widths[i] = cubCellSet.getUnpaddedWidth(i);
+    }
+    _cellsRank.Resize(widths);
+    CreateSlabs(cubCellSet);
+    std::vector<bool> allSlabs(_slabs.size(), true);
+
+    // all the cells left in the quotient are faces of its top dimensional
+    // cells (the difference of two closed sets), so no graph is needed:
+    // the first sweep numbers the cells of each slab within each dimension,
+    // then the cells are emitted with ids fixed up by the slabs offsets
+    ForEachSlab(&CollapsedAKQReducedCubSComplexSupplier::CountSlabCells, cubCellSet, allSlabs);
+    size_t totalCellsCount = SetOffsets();
+    ForEachSlab(&CollapsedAKQReducedCubSComplexSupplier::EmitSlabCells, cubCellSet, allSlabs);
+    FillDims(totalCellsCount, dims);
+
+    // slabs of an editable input are kept for the updates
+    bool keepSlabs = static_cast<bool>(_inputCubSet);
+    ConcatenateSlabs(kappaMap, keepSlabs);
+    if (!keepSlabs)
     {
-        int ci = complex->coincidenceIndex(cell, *it);
-        assert(ci != 0);
-        boundary.push_back(std::pair<Id, int>(it->getId(), ci));
+        std::vector<Slab>().swap(_slabs);
+        CellsRank<DIM>().Swap(_cellsRank);
     }
-    return boundary;
 }
 
 template <typename Traits>
-void CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateKappaMapFromQuotient(
-                                                         CubCellSetPtr cubCellSet,
-                                                         Dims& dims,
-                                                         KappaMap& kappaMap)
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::UpdateQuotientCubCellSet(const Positions& changed,
+                                                                               std::vector<bool>& countedSlabs)
 {
-    _allCells.clear();
-    _cellsMapByDim.clear();
-
-    _nullSetCell = new CellDescriptor(0, 0);
-    _allCells.push_back(_nullSetCell);
-    _cellsCountByDim[0] = 1;
+    typedef typename CubCellSet::BitIterator CellIterator;
+    int closureCount = 1;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        closureCount *= 3;
+    }
 
-    size_t maxDim = static_cast<size_t>(cubCellSet().embDim());
-    PointCoordIterator it = PointCoordIterator(cubCellSet().begin());
-    BitCoordIterator itEnd = cubCellSet().end();
-    for ( ; it < itEnd; ++it)
+    // only the cells of the closures of the changed cubes may change
+    int coords[DIM];
+    int cellCoords[DIM];
+    typename Positions::const_iterator it = changed.begin();
+    typename Positions::const_iterator itEnd = changed.end();
+    for ( ; it != itEnd; ++it)
     {
-        if (it.ownDim() == maxDim)
+        _reductionsLog.GetCoords(*it, coords);
+        for (int k = 0; k < closureCount; k++)
         {
-            CreateCell(cubCellSet, it, maxDim);
+            int code = k;
+            for (int dim = 0; dim < DIM; dim++)
+            {
+                cellCoords[dim] = 2 * coords[dim] + code % 3;
+                code /= 3;
+            }
+            CellIterator cellIt = CellIterator(*_quotientCubCellSet, cellCoords);
+            bool inQuotient = IsQuotientCell(cellCoords);
+            if (cellIt.getBit() == inQuotient)
+            {
+                continue;
+            }
+            if (inQuotient)
+            {
+                cellIt.setBit();
+            }
+            else
+            {
+                cellIt.clearBit();
+            }
+            countedSlabs[cellCoords[DIM - 1] / _slabWidth] = true;
         }
     }
+}
 
-    std::map<size_t, size_t> cellsIndicesOffsets;
-    size_t totalCellsCount = 0;
-    for (size_t i = 0; i <= maxDim; i++)
+template <typename Traits>
+bool CollapsedAKQReducedCubSComplexSupplier<Traits>::IsQuotientCell(const int* cellCoords)
+{
+    // the cell is left in the quotient if it is a face of a cube of the
+    // difference and of no cube of the acyclic subset; a cell with odd
+    // coordinate lies in one cube in that direction, with even in two
+    typedef typename CubSet::BitIterator Iterator;
+    CubSet& shavedCubSet = _reductionsLog.GetShavedCubSet();
+    CubSet& acyclicCubSet = _reductionsLog.GetAcyclicCubSet();
+    int cubesCount = 1 << DIM;
+    int coords[DIM];
+    bool inDifference = false;
+    for (int k = 0; k < cubesCount; k++)
     {
-        if (i > 0)
+        bool inside = true;
+        for (int dim = 0; dim < DIM; dim++)
+        {
+            int shift = (k >> dim) & 1;
+            if (cellCoords[dim] & 1)
+            {
+                inside = inside && shift == 0;
+                coords[dim] = cellCoords[dim] / 2;
+            }
+            else
+            {
+                coords[dim] = cellCoords[dim] / 2 - shift;
+            }
+            inside = inside && coords[dim] >= 0 && coords[dim] < shavedCubSet.getUnpaddedWidth(dim);
+        }
+        if (!inside)
+        {
+            continue;
+        }
+        if (Iterator(acyclicCubSet, coords).getBit())
         {
-            cellsIndicesOffsets[i] = cellsIndicesOffsets[i - 1] + _cellsCountByDim[i - 1];
+            return false;
         }
-        totalCellsCount += _cellsCountByDim[i];
-        _logger.Log(FGLogger::Debug)<<_cellsCountByDim[i]<<" cells in dim "<<i;
-        _logger.Log(FGLogger::Debug)<<" with offset "<<cellsIndicesOffsets[i]<<std::endl;
+        inDifference = inDifference || Iterator(shavedCubSet, coords).getBit();
     }
-    _logger.Log(FGLogger::Debug)<<"total cells generated: "<<totalCellsCount<<std::endl;
+    return inDifference;
+}
 
-    dims.resize(totalCellsCount);
-    kappaMap.clear();
-
-    typename CellsDescriptors::iterator jt = _allCells.begin();
-    typename CellsDescriptors::iterator jtEnd = _allCells.end();
-    for ( ; jt != jtEnd; ++jt)
-    {
-        CellDescriptor* cell = *jt;
-        size_t index = cell->_index + cellsIndicesOffsets[cell->_dim];
-        size_t faceIndexOffset = cellsIndicesOffsets[cell->_dim - 1];
-        dims[index] = cell->_dim;
-        std::vector<int>::iterator cIt = cell->_coefficients.begin();
-        for (typename CellsDescriptors::iterator fIt = cell->_faces.begin();
-                                                 fIt != cell->_faces.end();
-                                                 ++fIt)
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::UpdateKappaMap(const std::vector<bool>& countedSlabs,
+                                                                     Dims& dims,
+                                                                     KappaMap& kappaMap)
+{
+    // ranks of all the cells of a counted slab may change, so its
+    // neighbours are emitted again too (their cells may have faces in it),
+    // the other slabs keep their entries with ids shifted by new offsets
+    std::vector<bool> emittedSlabs(countedSlabs);
+    for (size_t i = 0; i < _slabs.size(); i++)
+    {
+        if (countedSlabs[i])
         {
-            CellDescriptor* face = *fIt;
-            kappaMap.push_back(KappaMapEntry(static_cast<Id>(index),
-                                             static_cast<Id>(face->_index + faceIndexOffset),
-                                             *cIt));
-            cIt++;
+            emittedSlabs[i - (i > 0 ? 1 : 0)] = true;
+            emittedSlabs[std::min(i + 1, _slabs.size() - 1)] = true;
         }
     }
+    std::vector<Id> oldOffsets;
+    GetOffsets(oldOffsets);
+    ForEachSlab(&CollapsedAKQReducedCubSComplexSupplier::CountSlabCells, *_quotientCubCellSet, countedSlabs);
+    size_t totalCellsCount = SetOffsets();
+    std::vector<Id> newOffsets;
+    GetOffsets(newOffsets);
+    if (newOffsets != oldOffsets)
+    {
+        for (size_t i = 0; i < _slabs.size(); i++)
+        {
+            for (size_t j = 0; j <= DIM && !emittedSlabs[i]; j++)
+            {
+                _slabs[i]._kappaMaps[j].Renumber(oldOffsets, newOffsets);
+            }
+        }
+    }
+    ForEachSlab(&CollapsedAKQReducedCubSComplexSupplier::EmitSlabCells, *_quotientCubCellSet, emittedSlabs);
+    FillDims(totalCellsCount, dims);
+    ConcatenateSlabs(kappaMap, true);
+
+    _updateStats._countedSlabs = std::count(countedSlabs.begin(), countedSlabs.end(), true);
+    _updateStats._emittedSlabs = std::count(emittedSlabs.begin(), emittedSlabs.end(), true);
+    _updateStats._slabsCount = _slabs.size();
+    _logger.Log(FGLogger::Debug)<<_updateStats._emittedSlabs<<" of "<<_slabs.size()<<" slabs emitted"<<std::endl;
+}
 
-    jt = _allCells.begin();
-    for ( ; jt != jtEnd; ++jt)
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateSlabs(CubCellSet& cubCellSet)
+{
+    // slabs are cut along the last axis, as only then each of them is
+    // a contiguous range of bits which can be swept sequentially
+    int width = cubCellSet.getUnpaddedWidth(DIM - 1);
+    if (_inputCubSet)
+    {
+        // thin slabs, so that an edit makes only a few of them emitted again
+        _slabWidth = EDITABLE_SLAB_WIDTH;
+    }
+    else
     {
-        delete *jt;
+        int slabsCount = std::min(GetThreadsCount(), std::max(width, 1));
+        _slabWidth = std::max((width + slabsCount - 1) / slabsCount, 1);
     }
+    int slabsCount = (width + _slabWidth - 1) / _slabWidth;
+    _slabs.assign(std::max(slabsCount, 1), Slab());
+    for (size_t i = 0; i < _slabs.size(); i++)
+    {
+        Slab& slab = _slabs[i];
+        slab._begin = static_cast<int>(i) * _slabWidth;
+        slab._end = std::min(slab._begin + _slabWidth, width);
+        slab._cellsCount.assign(DIM + 1, 0);
+        slab._offsets.assign(DIM + 1, 0);
+        slab._kappaMaps.resize(DIM + 1);
+    }
+    _logger.Log(FGLogger::Debug)<<_slabs.size()<<" slabs of width "<<_slabWidth<<std::endl;
 }
 
 template <typename Traits>
-typename CollapsedAKQReducedCubSComplexSupplier<Traits>::CellDescriptor*
-CollapsedAKQReducedCubSComplexSupplier<Traits>::AddCell(CubCellSetPtr cubCellSet,
-                                                        BitCoordIterator& it,
-                                                        size_t dim)
+int CollapsedAKQReducedCubSComplexSupplier<Traits>::GetThreadsCount() const
 {
-    CellDescriptor* cell = _cellsMapByDim[dim][it];
-    if (cell != 0)
+    int threadsCount = _options._threadsCount;
+    if (threadsCount <= 0)
     {
-        return cell;
+        threadsCount = static_cast<int>(std::thread::hardware_concurrency());
     }
-    return CreateCell(cubCellSet, it, dim);
+    return std::max(threadsCount, 1);
 }
 
 template <typename Traits>
-typename CollapsedAKQReducedCubSComplexSupplier<Traits>::CellDescriptor*
-CollapsedAKQReducedCubSComplexSupplier<Traits>::CreateCell(CubCellSetPtr cubCellSet,
-                                                           BitCoordIterator& it,
-                                                           size_t dim)
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::ForEachSlab(SlabMethod method,
+                                                                 CubCellSet& cubCellSet,
+                                                                 const std::vector<bool>& selected)
 {
-    size_t index = _cellsCountByDim[dim]++;
-    CellDescriptor* cell = new CellDescriptor(index, dim);
-    _allCells.push_back(cell);
-    _cellsMapByDim[dim][it] = cell;
+    int selectedCount = static_cast<int>(std::count(selected.begin(), selected.end(), true));
+    int threadsCount = std::max(std::min(GetThreadsCount(), selectedCount), 1);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadsCount; i++)
+    {
+        threads.push_back(std::thread(&CollapsedAKQReducedCubSComplexSupplier::RunSlabs, this,
+                                      method, &cubCellSet, &selected, i, threadsCount));
+    }
+    RunSlabs(method, &cubCellSet, &selected, 0, threadsCount);
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::RunSlabs(SlabMethod method,
+                                                              CubCellSet* cubCellSet,
+                                                              const std::vector<bool>* selected,
+                                                              int thread,
+                                                              int threadsCount)
+{
+    // every thread takes every threadsCount-th of the selected slabs
+    int index = 0;
+    for (size_t i = 0; i < _slabs.size(); i++)
+    {
+        if ((*selected)[i] && index++ % threadsCount == thread)
+        {
+            (this->*method)(cubCellSet, &_slabs[i]);
+        }
+    }
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::CountSlabCells(CubCellSet* cubCellSet, Slab* slab)
+{
+    _cellsRank.Clear(slab->_begin, slab->_end);
+    int coords[DIM] = { 0 };
+    coords[DIM - 1] = slab->_begin;
+    PointCoordIterator it = PointCoordIterator(*cubCellSet, coords);
+    BitCoordIterator itEnd = cubCellSet->end();
+    for ( ; it < itEnd && it.coord(DIM - 1) < slab->_end; ++it)
+    {
+        // the first bit of the slab may be empty
+        if (it.getBit())
+        {
+            _cellsRank.Insert(it);
+        }
+    }
+    // slabs consist of whole rows of the rank, so they are built independently
+    _cellsRank.Build(slab->_begin, slab->_end, slab->_cellsCount);
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::EmitSlabCells(CubCellSet* cubCellSet, Slab* slab)
+{
+    // cells are emitted dimension by dimension, in the linear order within
+    // each of them (i.e. in the order of ids), so the bitmap of the slab
+    // is always read sequentially
+    int coords[DIM] = { 0 };
+    coords[DIM - 1] = slab->_begin;
+    BitCoordIterator itEnd = cubCellSet->end();
     std::vector<BitCoordIterator> faces;
     std::vector<int> coefficients;
-    if (dim == 2) // hack to obtain proper order of 2boundary
+    std::vector<Id> faceIds;
+    for (size_t dim = 1; dim <= DIM; dim++)
     {
-        cubCellSet().getOrdered2Faces(it, faces, coefficients);
+        KappaMap& kappaMap = slab->_kappaMaps[dim];
+        kappaMap.Clear();
+        // cell of dimension d has at most 2d faces
+        kappaMap.Reserve(2 * dim * slab->_cellsCount[dim]);
+        PointCoordIterator it = PointCoordIterator(*cubCellSet, coords);
+        for ( ; it < itEnd && it.coord(DIM - 1) < slab->_end; ++it)
+        {
+            if (!it.getBit() || it.ownDim() != dim)
+            {
+                continue;
+            }
+            Id id = GetCellId(it, dim);
+            GetFaces(*cubCellSet, it, dim, faces, coefficients);
+            faceIds.resize(faces.size());
+            for (size_t i = 0; i < faces.size(); i++)
+            {
+                faceIds[i] = GetCellId(faces[i], dim - 1);
+            }
+            // adding null point cell to each "non complete" 1-cell boundary
+            if (dim == 1 && faceIds.size() == 1)
+            {
+                if (coefficients[0] == 1)
+                {
+                    kappaMap.Append(id, faceIds[0], 1);
+                    kappaMap.Append(id, static_cast<Id>(0), -1);
+                }
+                else // if (coefficients[0] == -1)
+                {
+                    kappaMap.Append(id, static_cast<Id>(0), 1);
+                    kappaMap.Append(id, faceIds[0], -1);
+                }
+                continue;
+            }
+            for (size_t i = 0; i < faceIds.size(); i++)
+            {
+                kappaMap.Append(id, faceIds[i], coefficients[i]);
+            }
+        }
     }
-    else
+}
+
+template <typename Traits>
+size_t CollapsedAKQReducedCubSComplexSupplier<Traits>::SetOffsets()
+{
+    // ids are ordered by dimension, then by slab, then linearly within slab
+    // (0 is reserved for the null point)
+    size_t totalCellsCount = 1;
+    for (size_t i = 0; i <= DIM; i++)
     {
-        cubCellSet().getFaces(it, faces, coefficients);
+        size_t dimOffset = (i == 0) ? 0 : totalCellsCount;
+        for (size_t j = 0; j < _slabs.size(); j++)
+        {
+            _slabs[j]._offsets[i] = totalCellsCount;
+            totalCellsCount += _slabs[j]._cellsCount[i];
+        }
+        _logger.Log(FGLogger::Debug)<<totalCellsCount - dimOffset<<" cells in dim "<<i;
+        _logger.Log(FGLogger::Debug)<<" with offset "<<dimOffset<<std::endl;
     }
-    typename std::vector<BitCoordIterator>::iterator fIt = faces.begin();
-    typename std::vector<BitCoordIterator>::iterator fItEnd = faces.end();
-    std::vector<int>::iterator cIt = coefficients.begin();
-    for ( ; fIt != fItEnd; ++fIt)
+    _logger.Log(FGLogger::Debug)<<"total cells generated: "<<totalCellsCount<<std::endl;
+    if (totalCellsCount - 1 > static_cast<size_t>(std::numeric_limits<Id>::max()))
+    {
+        throw std::runtime_error("number of cells of the quotient space exceeds the range of ids");
+    }
+    _logger.Log(FGLogger::Debug)<<"cells rank size: "<<_cellsRank.Bytes()<<" bytes"<<std::endl;
+    return totalCellsCount;
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::GetOffsets(std::vector<Id>& offsets) const
+{
+    // the first range holds the null point
+    offsets.assign(1, static_cast<Id>(0));
+    for (size_t i = 0; i <= DIM; i++)
     {
-        cell->_faces.push_back(AddCell(cubCellSet, *fIt, dim - 1));
-        cell->_coefficients.push_back(*cIt);
-        cIt++;
+        for (size_t j = 0; j < _slabs.size(); j++)
+        {
+            offsets.push_back(static_cast<Id>(_slabs[j]._offsets[i]));
+        }
     }
-    // adding null point cell to each "non complete" 1-cell boundary
-    if (dim == 1 && cell->_faces.size() < 2)
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::FillDims(size_t cellsCount, Dims& dims) const
+{
+    dims.assign(cellsCount, 0);
+    for (size_t i = 1; i <= DIM; i++)
     {
-        if (cell->_faces.size() == 0)
+        for (size_t j = 0; j < _slabs.size(); j++)
         {
-            //cell->_faces.push_back(_nullSetCell);
-            //cell->_faces.push_back(_nullSetCell);
-            //cell->_coefficients.push_back(1);
-            //cell->_coefficients.push_back(0);
+            size_t offset = _slabs[j]._offsets[i];
+            std::fill(dims.begin() + offset, dims.begin() + offset + _slabs[j]._cellsCount[i], i);
         }
-        else if (cell->_coefficients[0] == 1)
+    }
+}
+
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::ConcatenateSlabs(KappaMap& kappaMap, bool keepSlabs)
+{
+    // concatenating in the order of ids, so faces always come before
+    // their cofaces
+    size_t entriesCount = 0;
+    for (size_t i = 0; i <= DIM; i++)
+    {
+        for (size_t j = 0; j < _slabs.size(); j++)
         {
-            cell->_faces.push_back(_nullSetCell);
-            cell->_coefficients.push_back(-1);
+            entriesCount += _slabs[j]._kappaMaps[i].Size();
         }
-        else // if (cell->_coefficients[0] == -1)
+    }
+    kappaMap.Clear();
+    kappaMap.Reserve(entriesCount);
+    for (size_t i = 0; i <= DIM; i++)
+    {
+        for (size_t j = 0; j < _slabs.size(); j++)
         {
-            cell->_faces.push_back(cell->_faces[0]);
-            cell->_coefficients.push_back(-1);
-            cell->_faces[0] = _nullSetCell;
-            cell->_coefficients[0] = 1;
+            KappaMap& slabKappaMap = _slabs[j]._kappaMaps[i];
+            kappaMap.Append(slabKappaMap);
+            if (!keepSlabs)
+            {
+                KappaMap().Swap(slabKappaMap);
+            }
         }
     }
-    return cell;
 }
 
 template <typename Traits>
-void CollapsedAKQReducedCubSComplexSupplier<Traits>::PrintDebug()
+typename CollapsedAKQReducedCubSComplexSupplier<Traits>::Id
+CollapsedAKQReducedCubSComplexSupplier<Traits>::GetCellId(const BitCoordIterator& it, size_t dim) const
 {
-    _logger.Log(FGLogger::Debug)<<"extracted signature:"<<std::endl<<_algorithm->getExtractedSignature()<<std::endl;
+    const Slab& slab = _slabs[it.coord(DIM - 1) / _slabWidth];
+    return static_cast<Id>(slab._offsets[dim] + _cellsRank.Rank(it));
+}
 
-    OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
-    std::vector<int> betti = HomologyHelpers<Traits>::GetHomologySignature(outputComplex);
-    _logger.Log(FGLogger::Debug)<<"homology signature:"<<std::endl;
-    for (int i = 0; i < betti.size(); ++i)
+template <typename Traits>
+void CollapsedAKQReducedCubSComplexSupplier<Traits>::GetFaces(CubCellSet& cubCellSet,
+                                                              BitCoordIterator& it,
+                                                              size_t dim,
+                                                              std::vector<BitCoordIterator>& faces,
+                                                              std::vector<int>& coefficients)
+{
+    faces.clear();
+    coefficients.clear();
+    if (dim == 2) // hack to obtain proper order of 2boundary
+    {
+        cubCellSet.getOrdered2Faces(it, faces, coefficients);
+    }
+    else
     {
-        _logger.Log(FGLogger::Debug)<<"H_"<<i<<" = Z^"<<betti[i]<<std::endl;
+        cubCellSet.getFaces(it, faces, coefficients);
     }
 }
 
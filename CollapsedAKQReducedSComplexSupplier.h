@@ -0,0 +1,77 @@
+/*
+ * File:   CollapsedAKQReducedSComplexSupplier.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef COLLAPSEDAKQREDUCEDSCOMPLEXSUPPLIER_H
+#define	COLLAPSEDAKQREDUCEDSCOMPLEXSUPPLIER_H
+
+#include <deque>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "DebugComplexType.h"
+#include "FGOptions.h"
+#include "InlineVector.h"
+#include "QuotientAKQSupplier.h"
+
+// Counterpart of CollapsedAKQReducedCubSComplexSupplier for simplicial and
+// general complexes: collapsible subcomplex is grown greedily by elementary
+// expansions, collapsed to a point and AKQ reduction is performed
+// on the quotient complex.
+template <typename Traits>
+class CollapsedAKQReducedSComplexSupplier : public QuotientAKQSupplier<Traits>
+{
+public:
+
+    typedef typename Traits::SComplexType           OriginalSComplex;
+    typedef boost::shared_ptr<OriginalSComplex>     OriginalSComplexPtr;
+
+private:
+
+    typedef QuotientAKQSupplier<Traits>             Base;
+    typedef typename Base::Dims                     Dims;
+    typedef typename Base::KappaMap                 KappaMap;
+
+    typedef typename OriginalSComplex::Id           OriginalId;
+    typedef typename OriginalSComplex::Cell         OriginalCell;
+    typedef typename OriginalSComplex::Dim          OriginalDim;
+    typedef typename OriginalSComplex::Iterators::DimCells  OriginalDimCells;
+    typedef typename OriginalSComplex::Iterators::BdCells   OriginalBdCells;
+    typedef typename OriginalSComplex::Iterators::CbdCells  OriginalCbdCells;
+    typedef InlineVector<std::pair<OriginalId, int>, 4>     OriginalBoundary;
+
+public:
+
+    typedef typename Base::Id                       Id;
+
+    CollapsedAKQReducedSComplexSupplier(const char* filename, const FGOptions& options = FGOptions());
+    CollapsedAKQReducedSComplexSupplier(DebugComplexType type, const FGOptions& options = FGOptions());
+    CollapsedAKQReducedSComplexSupplier(OriginalSComplexPtr originalSComplex, const FGOptions& options = FGOptions());
+
+private:
+
+    using Base::CreateAlgorithm;
+    using Base::_logger;
+    using Base::_options;
+
+    void CreateComplex(OriginalSComplexPtr originalComplex);
+
+    // marks cells of a collapsible subcomplex (indexed by original ids)
+    void FindCollapsibleSubcomplex(OriginalSComplex& complex, std::vector<char>& subcomplex);
+    bool TryExpand(OriginalSComplex& complex, const OriginalId& cellId,
+                   std::vector<char>& subcomplex, std::deque<OriginalId>& added);
+    void CreateKappaMapFromQuotient(OriginalSComplex& complex, const std::vector<char>& subcomplex,
+                                    Dims& dims, KappaMap& kappaMap);
+    // boundary of 2-cell ordered so that its 1-cells form a closed path
+    OriginalBoundary GetLoopBoundary(OriginalSComplex& complex, const OriginalCell& cell);
+    // endpoints of 1-cell traversed according to the sign of coefficient
+    void GetEndpoints(OriginalSComplex& complex, const std::pair<OriginalId, int>& edge,
+                      OriginalId& begin, OriginalId& end);
+
+    static const size_t NO_CELL;
+};
+
+#include "CollapsedAKQReducedSComplexSupplier.hpp"
+
+#endif	/* COLLAPSEDAKQREDUCEDSCOMPLEXSUPPLIER_H */
@@ -0,0 +1,352 @@
+/*
+ * File:   CollapsedAKQReducedSComplexSupplier.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef COLLAPSEDAKQREDUCEDSCOMPLEXSUPPLIER_HPP
+#define	COLLAPSEDAKQREDUCEDSCOMPLEXSUPPLIER_HPP
+
+#include "CollapsedAKQReducedSComplexSupplier.h"
+
+#include <algorithm>
+
+#include "SComplexFactory.h"
+
+template <typename Traits>
+const size_t CollapsedAKQReducedSComplexSupplier<Traits>::NO_CELL = static_cast<size_t>(-1);
+
+template <typename Traits>
+CollapsedAKQReducedSComplexSupplier<Traits>::CollapsedAKQReducedSComplexSupplier(const char* filename,
+                                                                                 const FGOptions& options)
+    : Base(options)
+{
+    CreateComplex(SComplexFactory<OriginalSComplex>::Load(filename, _options._skeletonDim));
+}
+
+template <typename Traits>
+CollapsedAKQReducedSComplexSupplier<Traits>::CollapsedAKQReducedSComplexSupplier(DebugComplexType type,
+                                                                                 const FGOptions& options)
+    : Base(options)
+{
+    CreateComplex(SComplexFactory<OriginalSComplex>::Create(type));
+}
+
+template <typename Traits>
+CollapsedAKQReducedSComplexSupplier<Traits>::CollapsedAKQReducedSComplexSupplier(OriginalSComplexPtr originalSComplex,
+                                                                                 const FGOptions& options)
+    : Base(options)
+{
+    CreateComplex(originalSComplex);
+}
+
+template <typename Traits>
+void CollapsedAKQReducedSComplexSupplier<Traits>::CreateComplex(OriginalSComplexPtr originalComplex)
+{
+    _logger.Begin(FGLogger::Details, "computing collapsible subcomplex");
+    std::vector<char> subcomplex;
+    FindCollapsibleSubcomplex(*originalComplex, subcomplex);
+    _logger.End();
+    _logger.Log(FGLogger::Details)<<"collapsible subcomplex size: "
+                                  <<std::count(subcomplex.begin(), subcomplex.end(), 1)<<std::endl;
+
+    _logger.Begin(FGLogger::Details, "creating kappa-map for quotient space");
+    Dims dims;
+    KappaMap kappaMap;
+    CreateKappaMapFromQuotient(*originalComplex, subcomplex, dims, kappaMap);
+    _logger.End();
+
+    // original complex (unless shared with the caller) is released
+    // before the quotient complex is created
+    std::vector<char>().swap(subcomplex);
+    originalComplex.reset();
+
+    CreateAlgorithm(dims, kappaMap);
+}
+
+template <typename Traits>
+void CollapsedAKQReducedSComplexSupplier<Traits>::FindCollapsibleSubcomplex(OriginalSComplex& complex,
+                                                                            std::vector<char>& subcomplex)
+{
+    int maxDim = static_cast<int>(complex.getDim());
+    size_t cellsCount = 0;
+    for (int dim = 0; dim <= maxDim; dim++)
+    {
+        OriginalDimCells dimCells = complex.iterators().dimCells(static_cast<OriginalDim>(dim));
+        typename OriginalDimCells::iterator it = dimCells.begin();
+        typename OriginalDimCells::iterator itEnd = dimCells.end();
+        for ( ; it != itEnd; ++it)
+        {
+            cellsCount = std::max(cellsCount, static_cast<size_t>(it->getId()) + 1);
+        }
+    }
+    subcomplex.assign(cellsCount, 0);
+
+    OriginalDimCells vertices = complex.iterators().dimCells(static_cast<OriginalDim>(0));
+    if (vertices.begin() == vertices.end())
+    {
+        return;
+    }
+
+    // subcomplex grows from a single vertex by elementary expansions
+    // (free pairs of cells), so it always stays collapsible
+    std::deque<OriginalId> added;
+    OriginalId seed = vertices.begin()->getId();
+    subcomplex[seed] = 1;
+    added.push_back(seed);
+    while (!added.empty())
+    {
+        OriginalCell cell = complex[added.front()];
+        added.pop_front();
+        // adding the cell can make its cofaces expandable (as the higher
+        // cell of a pair) or cofaces of its cofaces (as the lower one)
+        OriginalCbdCells cbdCells = complex.iterators().cbdCells(cell);
+        typename OriginalCbdCells::iterator it = cbdCells.begin();
+        typename OriginalCbdCells::iterator itEnd = cbdCells.end();
+        for ( ; it != itEnd; ++it)
+        {
+            OriginalId coface = it->getId();
+            if (subcomplex[coface] || TryExpand(complex, coface, subcomplex, added))
+            {
+                continue;
+            }
+            OriginalCbdCells cbdCbdCells = complex.iterators().cbdCells(complex[coface]);
+            typename OriginalCbdCells::iterator jt = cbdCbdCells.begin();
+            typename OriginalCbdCells::iterator jtEnd = cbdCbdCells.end();
+            for ( ; jt != jtEnd && !subcomplex[coface]; ++jt)
+            {
+                if (!subcomplex[jt->getId()])
+                {
+                    TryExpand(complex, jt->getId(), subcomplex, added);
+                }
+            }
+        }
+    }
+}
+
+template <typename Traits>
+bool CollapsedAKQReducedSComplexSupplier<Traits>::TryExpand(OriginalSComplex& complex,
+                                                            const OriginalId& cellId,
+                                                            std::vector<char>& subcomplex,
+                                                            std::deque<OriginalId>& added)
+{
+    // exactly one face of the cell can be outside of the subcomplex,
+    // it has to be a regular face with all its own faces in the subcomplex
+    OriginalCell cell = complex[cellId];
+    OriginalBdCells bdCells = complex.iterators().bdCells(cell);
+    typename OriginalBdCells::iterator it = bdCells.begin();
+    typename OriginalBdCells::iterator itEnd = bdCells.end();
+    size_t outsideCount = 0;
+    OriginalId freeFace = cellId;
+    int coefficient = 0;
+    for ( ; it != itEnd; ++it)
+    {
+        if (!subcomplex[it->getId()])
+        {
+            outsideCount++;
+            freeFace = it->getId();
+            coefficient = complex.coincidenceIndex(cell, *it);
+        }
+    }
+    if (outsideCount != 1 || (coefficient != 1 && coefficient != -1))
+    {
+        return false;
+    }
+
+    OriginalBdCells faceBdCells = complex.iterators().bdCells(complex[freeFace]);
+    it = faceBdCells.begin();
+    itEnd = faceBdCells.end();
+    for ( ; it != itEnd; ++it)
+    {
+        if (!subcomplex[it->getId()])
+        {
+            return false;
+        }
+    }
+
+    subcomplex[freeFace] = 1;
+    subcomplex[cellId] = 1;
+    added.push_back(freeFace);
+    added.push_back(cellId);
+    return true;
+}
+
+template <typename Traits>
+void CollapsedAKQReducedSComplexSupplier<Traits>::CreateKappaMapFromQuotient(
+                                                         OriginalSComplex& complex,
+                                                         const std::vector<char>& subcomplex,
+                                                         Dims& dims,
+                                                         KappaMap& kappaMap)
+{
+    // subcomplex is collapsed to the null point (id 0),
+    // the rest of the cells are numbered dimension by dimension
+    int maxDim = static_cast<int>(complex.getDim());
+    std::vector<size_t> ids(subcomplex.size(), NO_CELL);
+    size_t totalCellsCount = 1;
+    for (int dim = 0; dim <= maxDim; dim++)
+    {
+        size_t offset = totalCellsCount;
+        OriginalDimCells dimCells = complex.iterators().dimCells(static_cast<OriginalDim>(dim));
+        typename OriginalDimCells::iterator it = dimCells.begin();
+        typename OriginalDimCells::iterator itEnd = dimCells.end();
+        for ( ; it != itEnd; ++it)
+        {
+            if (!subcomplex[it->getId()])
+            {
+                ids[it->getId()] = totalCellsCount++;
+            }
+        }
+        _logger.Log(FGLogger::Debug)<<totalCellsCount - offset<<" cells in dim "<<dim;
+        _logger.Log(FGLogger::Debug)<<" with offset "<<offset<<std::endl;
+    }
+    _logger.Log(FGLogger::Debug)<<"total cells generated: "<<totalCellsCount<<std::endl;
+
+    dims.assign(totalCellsCount, 0);
+    kappaMap.Clear();
+    for (int dim = 1; dim <= maxDim; dim++)
+    {
+        OriginalDimCells dimCells = complex.iterators().dimCells(static_cast<OriginalDim>(dim));
+        typename OriginalDimCells::iterator it = dimCells.begin();
+        typename OriginalDimCells::iterator itEnd = dimCells.end();
+        for ( ; it != itEnd; ++it)
+        {
+            if (subcomplex[it->getId()])
+            {
+                continue;
+            }
+            OriginalCell cell = complex[it->getId()];
+            Id id = static_cast<Id>(ids[it->getId()]);
+            dims[id] = dim;
+            OriginalBoundary boundary;
+            if (dim == 2)
+            {
+                boundary = GetLoopBoundary(complex, cell);
+            }
+            else
+            {
+                OriginalBdCells bdCells = complex.iterators().bdCells(cell);
+                typename OriginalBdCells::iterator jt = bdCells.begin();
+                typename OriginalBdCells::iterator jtEnd = bdCells.end();
+                for ( ; jt != jtEnd; ++jt)
+                {
+                    boundary.push_back(std::make_pair(jt->getId(), complex.coincidenceIndex(cell, *jt)));
+                }
+            }
+
+            if (dim == 1)
+            {
+                // vertices of the subcomplex become the null point,
+                // 1-cell with both ends there becomes a loop
+                if (boundary.size() == 2 && subcomplex[boundary[0].first] && subcomplex[boundary[1].first])
+                {
+                    continue;
+                }
+                for (size_t i = 0; i < boundary.size(); i++)
+                {
+                    if (boundary[i].second == 0)
+                    {
+                        continue;
+                    }
+                    Id faceId = subcomplex[boundary[i].first] ? static_cast<Id>(0)
+                                                              : static_cast<Id>(ids[boundary[i].first]);
+                    kappaMap.Append(id, faceId, boundary[i].second);
+                }
+                continue;
+            }
+            // higher dimensional faces in the subcomplex are collapsed
+            for (size_t i = 0; i < boundary.size(); i++)
+            {
+                if (boundary[i].second != 0 && !subcomplex[boundary[i].first])
+                {
+                    kappaMap.Append(id, static_cast<Id>(ids[boundary[i].first]), boundary[i].second);
+                }
+            }
+        }
+    }
+}
+
+template <typename Traits>
+typename CollapsedAKQReducedSComplexSupplier<Traits>::OriginalBoundary
+CollapsedAKQReducedSComplexSupplier<Traits>::GetLoopBoundary(OriginalSComplex& complex,
+                                                             const OriginalCell& cell)
+{
+    OriginalBoundary boundary;
+    OriginalBdCells bdCells = complex.iterators().bdCells(cell);
+    typename OriginalBdCells::iterator it = bdCells.begin();
+    typename OriginalBdCells::iterator itEnd = bdCells.end();
+    for ( ; it != itEnd; ++it)
+    {
+        boundary.push_back(std::make_pair(it->getId(), complex.coincidenceIndex(cell, *it)));
+    }
+    if (boundary.size() < 2)
+    {
+        return boundary;
+    }
+
+    // chaining 1-cells by their endpoints, if the boundary is not a closed
+    // path, it is left in the order given by the complex
+    OriginalBoundary loop;
+    std::vector<char> used(boundary.size(), 0);
+    OriginalId begin, end;
+    GetEndpoints(complex, boundary[0], begin, end);
+    loop.push_back(boundary[0]);
+    used[0] = 1;
+    while (loop.size() < boundary.size())
+    {
+        size_t next = boundary.size();
+        OriginalId nextEnd = end;
+        for (size_t i = 0; i < boundary.size() && next == boundary.size(); i++)
+        {
+            OriginalId edgeBegin, edgeEnd;
+            GetEndpoints(complex, boundary[i], edgeBegin, edgeEnd);
+            if (!used[i] && edgeBegin == end)
+            {
+                next = i;
+                nextEnd = edgeEnd;
+            }
+        }
+        if (next == boundary.size())
+        {
+            return boundary;
+        }
+        loop.push_back(boundary[next]);
+        used[next] = 1;
+        end = nextEnd;
+    }
+    return (end == begin) ? loop : boundary;
+}
+
+template <typename Traits>
+void CollapsedAKQReducedSComplexSupplier<Traits>::GetEndpoints(OriginalSComplex& complex,
+                                                               const std::pair<OriginalId, int>& edge,
+                                                               OriginalId& begin,
+                                                               OriginalId& end)
+{
+    // 1-cell goes from the vertex with coefficient -1 to the one with 1
+    OriginalCell cell = complex[edge.first];
+    OriginalBdCells bdCells = complex.iterators().bdCells(cell);
+    typename OriginalBdCells::iterator it = bdCells.begin();
+    typename OriginalBdCells::iterator itEnd = bdCells.end();
+    OriginalId tail = edge.first;
+    OriginalId head = edge.first;
+    size_t count = 0;
+    for ( ; it != itEnd; ++it, ++count)
+    {
+        if (complex.coincidenceIndex(cell, *it) > 0)
+        {
+            head = it->getId();
+        }
+        else
+        {
+            tail = it->getId();
+        }
+        if (count == 0)
+        {
+            // 1-cell with a single vertex is a loop
+            tail = head = it->getId();
+        }
+    }
+    begin = (edge.second > 0) ? tail : head;
+    end = (edge.second > 0) ? head : tail;
+}
+
+#endif	/* COLLAPSEDAKQREDUCEDSCOMPLEXSUPPLIER_HPP */
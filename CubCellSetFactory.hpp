@@ -62,6 +62,8 @@ CubCellSetFactory<CubCellSetT>::Create(Cubes& cubes, Bounds& bounds, bool shave)
         }
         cubCellSet().insert(&cube[0]);
     }
+    // cubes are not needed any more, they are released before filling
+    Cubes().swap(cubes);
     logger.End();
 
     logger.Begin(FGLogger::Details, "creating lower dimensional cubes");
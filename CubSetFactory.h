@@ -6,7 +6,10 @@
 #ifndef CUBSETFACTORY_H
 #define	CUBSETFACTORY_H
 
+#include <vector>
+
 #include "CubesSupplier.h"
+#include "GrayscaleVolume.h"
 
 template <typename CubSetT>
 class CubSetFactory
@@ -23,6 +26,15 @@ public:
 
     static CubSetPtr Load(const char* filename, bool shave);
     static CubSetPtr Create(DebugComplexType type, bool shave);
+    // origin receives input coordinates of the cube (0, ..., 0) of the set
+    static CubSetPtr Load(const char* filename, bool shave, std::vector<Coord>& origin);
+    static CubSetPtr Create(DebugComplexType type, bool shave, std::vector<Coord>& origin);
+    // sublevel set of the volume, voxels become cubes
+    template <typename ValueT>
+    static CubSetPtr Create(const GrayscaleVolume<ValueT>& volume, ValueT threshold, bool shave,
+                            std::vector<Coord>& origin);
+
+    static void Shave(CubSet& cubSet);
 
     template <typename CubCellSetPtr>
     static CubSetPtr ConvertCubCellSet(CubCellSetPtr cubCellSet, bool shave);
@@ -34,6 +46,7 @@ private:
     typedef typename CubesSupplier<Coord, DIM>::Bounds  Bounds;
 
     static CubSetPtr Create(Cubes& cubes, Bounds& bounds, bool shave);
+    static void GetOrigin(Bounds& bounds, std::vector<Coord>& origin);
 };
 
 #include "CubSetFactory.hpp"
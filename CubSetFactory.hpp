@@ -14,6 +14,8 @@
 
 #include "FGLogger.h"
 
+#include <stdexcept>
+
 template <typename CubSetT>
 typename CubSetFactory<CubSetT>::CubSetPtr
 CubSetFactory<CubSetT>::Load(const char* filename, bool shave)
@@ -34,6 +36,130 @@ CubSetFactory<CubSetT>::Create(DebugComplexType type, bool shave)
     return Create(cubes, bounds, shave);
 }
 
+template <typename CubSetT>
+typename CubSetFactory<CubSetT>::CubSetPtr
+CubSetFactory<CubSetT>::Load(const char* filename, bool shave, std::vector<Coord>& origin)
+{
+    Cubes cubes;
+    Bounds bounds;
+    CubesSupplier<Coord, DIM>::Load(filename, cubes, bounds);
+    GetOrigin(bounds, origin);
+    return Create(cubes, bounds, shave);
+}
+
+template <typename CubSetT>
+typename CubSetFactory<CubSetT>::CubSetPtr
+CubSetFactory<CubSetT>::Create(DebugComplexType type, bool shave, std::vector<Coord>& origin)
+{
+    Cubes cubes;
+    Bounds bounds;
+    CubesSupplier<Coord, DIM>::Create(type, cubes, bounds);
+    GetOrigin(bounds, origin);
+    return Create(cubes, bounds, shave);
+}
+
+template <typename CubSetT>
+template <typename ValueT>
+typename CubSetFactory<CubSetT>::CubSetPtr
+CubSetFactory<CubSetT>::Create(const GrayscaleVolume<ValueT>& volume, ValueT threshold, bool shave,
+                               std::vector<Coord>& origin)
+{
+    for (int dim = DIM; dim < GrayscaleVolume<ValueT>::MAX_DIM; dim++)
+    {
+        if (volume.GetSize(dim) > 1)
+        {
+            throw std::runtime_error("volume has more dimensions than the complex");
+        }
+    }
+
+    FGLogger logger;
+    logger.Begin(FGLogger::Details, "Creating CubSet of sublevel set");
+    int dimensions[DIM];
+    int coords[DIM];
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        dimensions[dim] = static_cast<int>(volume.GetSize(dim));
+        coords[dim] = 0;
+    }
+    // voxels are not shifted, only the empty collar is added
+    origin.assign(DIM, -1);
+
+    CubSetPtr cubSet = CubSetPtr(new CubSet(dimensions));
+
+    typename GrayscaleVolume<ValueT>::Mask mask;
+    volume.GetSublevelMask(threshold, mask);
+
+    // voxels are ordered as the bits of CubSet, so the set is filled in one pass
+    typedef typename CubSet::BitIterator Iterator;
+    Iterator it = Iterator(cubSet(), coords);
+    size_t count = mask.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        if (mask[i])
+        {
+            it.setBit();
+        }
+
+        // increment coord
+        int dim = 0;
+        bool ok = false;
+        while (!ok && dim < DIM)
+        {
+            coords[dim]++;
+            it.incInDir(dim);
+            if (coords[dim] < dimensions[dim])
+            {
+                ok = true;
+            }
+            else
+            {
+                it.decInDir(dim, dimensions[dim]);
+                coords[dim] = 0;
+                dim++;
+            }
+        }
+    }
+    cubSet().addEmptyCollar();
+    logger.End();
+    logger.Log(FGLogger::Details)<<"sublevel set of "<<threshold<<" has "<<cubSet().cardinality()<<" cubes"<<std::endl;
+
+    if (shave)
+    {
+        Shave(cubSet());
+    }
+
+    return cubSet;
+}
+
+template <typename CubSetT>
+void CubSetFactory<CubSetT>::Shave(CubSet& cubSet)
+{
+    FGLogger logger;
+    logger.Begin(FGLogger::Details, "loading acyclic configs");
+    readAcyclicConfigs();
+    logger.End();
+    logger.Begin(FGLogger::Details, "shaving");
+    size_t count = static_cast<size_t>(cubSet.cardinality());
+    cubSet.shaveBI();
+    if (logger.PrintShavedCellsCount())
+    {
+        count = count - static_cast<size_t>(cubSet.cardinality());
+        logger.Log(FGLogger::Details)<<"shaved "<<count<<" cubes"<<std::endl;
+    }
+    logger.End();
+}
+
+template <typename CubSetT>
+void CubSetFactory<CubSetT>::GetOrigin(Bounds& bounds, std::vector<Coord>& origin)
+{
+    // cubes are shifted by the lower bound and by the empty collar
+    origin.resize(DIM);
+    for (int i = 0; i < DIM; i++)
+    {
+        origin[i] = bounds[i]._min - 1;
+    }
+}
+
 template <typename CubSetT>
 template <typename CubCellSetPtr>
 typename CubSetFactory<CubSetT>::CubSetPtr
@@ -93,6 +219,11 @@ CubSetFactory<CubSetT>::ConvertCubCellSet(CubCellSetPtr cubCellSet, bool shave)
         }
     }
 
+    if (shave)
+    {
+        Shave(cubSet());
+    }
+
     return cubSet;
 }
 
@@ -125,22 +256,14 @@ CubSetFactory<CubSetT>::Create(Cubes& cubes, Bounds& bounds, bool shave)
         }
         cubSet().insert(&cube[0]);
     }
+    // cubes are not needed any more, they are released before shaving
+    Cubes().swap(cubes);
     cubSet().addEmptyCollar();
     logger.End();
 
     if (shave)
     {
-        logger.Begin(FGLogger::Details, "loading acyclic configs");
-        readAcyclicConfigs();
-        logger.End();
-        logger.Begin(FGLogger::Details, "shaving");
-        cubSet().shaveBI();
-        if (logger.PrintShavedCellsCount())
-        {
-            count = count - static_cast<size_t>(cubSet().cardinality());
-            logger.Log(FGLogger::Details)<<"shaved "<<count<<" cubes"<<std::endl;
-        }
-        logger.End();
+        Shave(cubSet());
     }
 
     return cubSet;
@@ -0,0 +1,116 @@
+/*
+ * File:   CubSetReductionsLog.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef CUBSETREDUCTIONSLOG_H
+#define	CUBSETREDUCTIONSLOG_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+// Shaving of a cubical set and growing of its acyclic subset done cube by
+// cube (with the neighbourhood acyclicity test of CubSet), every removal
+// of a shaved cube and every addition to the acyclic subset gets the next
+// step number. A step depends only on the cubes of its 3^DIM neighbourhood
+// present at that step, so after the input is edited only the steps next
+// to the edits are checked again against their neighbourhood at that step.
+// A step which does not pass is undone and the later steps next to the
+// undone cube are checked in turn. Then the cubes next to the changes are
+// shaved and added to the acyclic subset again.
+template <typename CubSetT>
+class CubSetReductionsLog
+{
+public:
+
+    typedef CubSetT                         CubSet;
+    typedef std::vector<size_t>             Positions;
+
+    enum
+    {
+        DIM = CubSet::theDim,
+    };
+
+    CubSetReductionsLog();
+
+    // shaves the copy of the input set and grows its acyclic subset,
+    // the input set is kept (and edited) by the caller
+    void Reduce(CubSet& inputCubSet);
+    // edited are positions of the cubes of the input set changed since
+    // the last call (repeated or reverted edits are allowed), changed
+    // receives positions of the cubes which entered or left the shaved
+    // set or the acyclic subset
+    void Update(const Positions& edited, Positions& changed);
+
+    // the acyclic subset is a part of the shaved set
+    CubSet& GetShavedCubSet();
+    CubSet& GetAcyclicCubSet();
+
+    // position of a cube in the set (the first coordinate changes fastest)
+    size_t GetPosition(const int* coords) const;
+    void GetCoords(size_t position, int* coords) const;
+
+private:
+
+    typedef typename CubSet::BitIterator                Iterator;
+    typedef boost::shared_ptr<CubSet>                   CubSetPtr;
+    typedef unsigned int                                Step;
+    typedef std::pair<Step, size_t>                     StepPosition;
+    // steps to check again, the earliest first
+    typedef std::priority_queue<StepPosition, std::vector<StepPosition>,
+                                std::greater<StepPosition> > StepsQueue;
+
+    static const size_t NO_POSITION;
+
+    bool IsShaved(const int* coords, size_t position);
+    // checks again the step of the shaved cube or the cube of the acyclic
+    // subset against the neighbourhood at that step
+    bool IsShavingValid(const int* coords, Step step);
+    bool IsAddingValid(const int* coords, size_t position, Step step);
+    void Restore(const int* coords, size_t position, StepsQueue& shavedQueue);
+    void Undo(const int* coords, size_t position, StepsQueue& acyclicQueue);
+    // shaved neighbours (cubes of the acyclic subset) with steps in (after, before)
+    void QueueShaved(const int* coords, Step after, Step before, StepsQueue& queue);
+    void QueueAcyclic(const int* coords, Step after, StepsQueue& queue);
+    template <typename Container>
+    void QueueNeighbourhood(const int* coords, Container& candidates);
+
+    // shaves the candidates, their neighbours are shaved then too
+    void Shave(Positions& candidates, Positions* changed);
+    // adds candidates which touch the acyclic subset, their neighbours
+    // are tried then too (the first cube of the set starts an empty subset)
+    void Grow(Positions& candidates, Positions* changed);
+    bool FindSeed(int* coords);
+    bool HasNeighbour(CubSet& cubSet, const int* coords);
+    bool GetNeighbour(const int* coords, int index, int* neighbourCoords) const;
+    Step NextStep();
+    void RenumberSteps();
+    void NextCoords(Iterator& it, int* coords) const;
+
+    CubSet*             _inputCubSet;
+    CubSetPtr           _shavedCubSet;
+    CubSetPtr           _acyclicCubSet;
+    int                 _widths[DIM];
+    size_t              _strides[DIM];
+    // offsets of the neighbours, DIM coordinates each
+    std::vector<int>    _neighbourOffsets;
+    int                 _neighboursCount;
+    // step of every shaved cube and of every cube of the acyclic subset
+    // (these are disjoint), 0 for the other cubes
+    std::vector<Step>   _steps;
+    Step                _lastStep;
+    // the first cube of the acyclic subset does not need any neighbours
+    size_t              _seed;
+    size_t              _acyclicCount;
+    // cubes set temporarily while a step is checked
+    Positions           _toggled;
+};
+
+#include "CubSetReductionsLog.hpp"
+
+#endif	/* CUBSETREDUCTIONSLOG_H */
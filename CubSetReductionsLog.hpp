@@ -0,0 +1,586 @@
+/*
+ * File:   CubSetReductionsLog.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef CUBSETREDUCTIONSLOG_HPP
+#define	CUBSETREDUCTIONSLOG_HPP
+
+#include "CubSetReductionsLog.h"
+
+#include <capd/cubSet/CubSetT.hpp>
+#include <capd/cubSet/acyclicConfigs.hpp>
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+#include "FGLogger.h"
+
+template <typename CubSetT>
+const size_t CubSetReductionsLog<CubSetT>::NO_POSITION = static_cast<size_t>(-1);
+
+template <typename CubSetT>
+CubSetReductionsLog<CubSetT>::CubSetReductionsLog()
+    : _inputCubSet(0)
+    , _neighboursCount(0)
+    , _lastStep(0)
+    , _seed(NO_POSITION)
+    , _acyclicCount(0)
+{
+    std::fill(_widths, _widths + DIM, 0);
+    std::fill(_strides, _strides + DIM, 0);
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::Reduce(CubSet& inputCubSet)
+{
+    FGLogger logger;
+    logger.Begin(FGLogger::Details, "loading acyclic configs");
+    readAcyclicConfigs();
+    CubSet::neighbAcyclicBI = &CubSet::neighbAcyclicLT;
+    logger.End();
+
+    _inputCubSet = &inputCubSet;
+    int coords[DIM];
+    size_t totalCount = 1;
+    int neighbourhoodSize = 1;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        _widths[dim] = inputCubSet.getUnpaddedWidth(dim);
+        _strides[dim] = totalCount;
+        totalCount *= _widths[dim];
+        neighbourhoodSize *= 3;
+    }
+    _neighbourOffsets.clear();
+    for (int k = 0; k < neighbourhoodSize; k++)
+    {
+        // the middle code is the cube itself
+        if (k == neighbourhoodSize / 2)
+        {
+            continue;
+        }
+        int code = k;
+        for (int dim = 0; dim < DIM; dim++)
+        {
+            _neighbourOffsets.push_back(code % 3 - 1);
+            code /= 3;
+        }
+    }
+    _neighboursCount = neighbourhoodSize - 1;
+
+    _shavedCubSet = CubSetPtr(new CubSet(inputCubSet));
+    _acyclicCubSet = CubSetPtr(new CubSet(inputCubSet));
+    _steps.assign(totalCount, 0);
+    _lastStep = 0;
+    _seed = NO_POSITION;
+    _acyclicCount = 0;
+
+    std::fill(coords, coords + DIM, 0);
+    Iterator acyclicIt = Iterator(*_acyclicCubSet, coords);
+    for (size_t i = 0; i < totalCount; i++)
+    {
+        acyclicIt.clearBit();
+        NextCoords(acyclicIt, coords);
+    }
+
+    logger.Begin(FGLogger::Details, "shaving");
+    // every cube is tried once in the order of the set, the neighbours
+    // of the shaved cubes are tried again
+    Positions candidates;
+    std::fill(coords, coords + DIM, 0);
+    Iterator it = Iterator(*_shavedCubSet, coords);
+    for (size_t i = 0; i < totalCount; i++)
+    {
+        if (it.getBit() && CubSet::neighbAcyclicBI(it))
+        {
+            it.clearBit();
+            _steps[i] = NextStep();
+            QueueNeighbourhood(coords, candidates);
+        }
+        NextCoords(it, coords);
+    }
+    Shave(candidates, 0);
+    logger.End();
+    logger.Log(FGLogger::Details)<<"shaved "<<_lastStep<<" cubes"<<std::endl;
+
+    logger.Begin(FGLogger::Details, "computing acyclic subspace");
+    Grow(candidates, 0);
+    logger.End();
+    logger.Log(FGLogger::Details)<<"computed acyclic subset size: "<<_acyclicCount<<std::endl;
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::Update(const Positions& edited, Positions& changed)
+{
+    assert(_inputCubSet != 0);
+    changed.clear();
+    Positions sorted(edited);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    StepsQueue shavedQueue;
+    StepsQueue acyclicQueue;
+    int coords[DIM];
+    typename Positions::iterator it = sorted.begin();
+    typename Positions::iterator itEnd = sorted.end();
+    for ( ; it != itEnd; ++it)
+    {
+        size_t position = *it;
+        GetCoords(position, coords);
+        Iterator shavedIt = Iterator(*_shavedCubSet, coords);
+        bool present = Iterator(*_inputCubSet, coords).getBit();
+        bool inShavedSet = shavedIt.getBit();
+        bool shaved = !inShavedSet && _steps[position] > 0;
+        if (present == (inShavedSet || shaved))
+        {
+            continue;
+        }
+        changed.push_back(position);
+        if (present)
+        {
+            // all the shaved neighbours were shaved without the cube
+            shavedIt.setBit();
+            QueueShaved(coords, 0, std::numeric_limits<Step>::max(), shavedQueue);
+        }
+        else if (inShavedSet)
+        {
+            if (Iterator(*_acyclicCubSet, coords).getBit())
+            {
+                Undo(coords, position, acyclicQueue);
+            }
+            // all the shaved neighbours were shaved with the cube
+            shavedIt.clearBit();
+            QueueShaved(coords, 0, std::numeric_limits<Step>::max(), shavedQueue);
+        }
+        else
+        {
+            // neighbours shaved before the cube were shaved with it
+            QueueShaved(coords, 0, _steps[position], shavedQueue);
+            _steps[position] = 0;
+        }
+    }
+
+    // steps are checked in their order, so that every step is checked
+    // after all the earlier steps of its neighbourhood are settled
+    size_t restoredCount = 0;
+    while (!shavedQueue.empty())
+    {
+        StepPosition top = shavedQueue.top();
+        while (!shavedQueue.empty() && shavedQueue.top() == top)
+        {
+            shavedQueue.pop();
+        }
+        GetCoords(top.second, coords);
+        if (_steps[top.second] != top.first || !IsShaved(coords, top.second)
+            || IsShavingValid(coords, top.first))
+        {
+            continue;
+        }
+        Restore(coords, top.second, shavedQueue);
+        changed.push_back(top.second);
+        restoredCount++;
+    }
+    size_t undoneCount = 0;
+    while (!acyclicQueue.empty())
+    {
+        StepPosition top = acyclicQueue.top();
+        while (!acyclicQueue.empty() && acyclicQueue.top() == top)
+        {
+            acyclicQueue.pop();
+        }
+        GetCoords(top.second, coords);
+        if (_steps[top.second] != top.first || !Iterator(*_acyclicCubSet, coords).getBit()
+            || IsAddingValid(coords, top.second, top.first))
+        {
+            continue;
+        }
+        Undo(coords, top.second, acyclicQueue);
+        changed.push_back(top.second);
+        undoneCount++;
+    }
+
+    // only the cubes next to the changes are shaved or added again
+    Positions candidates;
+    for (size_t i = 0; i < changed.size(); i++)
+    {
+        GetCoords(changed[i], coords);
+        candidates.push_back(changed[i]);
+        QueueNeighbourhood(coords, candidates);
+    }
+    Positions growCandidates(candidates);
+    size_t count = changed.size();
+    Shave(candidates, &changed);
+    size_t shavedCount = changed.size() - count;
+    count = changed.size();
+    Grow(growCandidates, &changed);
+
+    FGLogger logger;
+    logger.Log(FGLogger::Details)<<"restored "<<restoredCount<<" and shaved "<<shavedCount<<" cubes, ";
+    logger.Log(FGLogger::Details)<<"removed "<<undoneCount<<" and added "<<changed.size() - count;
+    logger.Log(FGLogger::Details)<<" cubes of acyclic subset"<<std::endl;
+}
+
+template <typename CubSetT>
+typename CubSetReductionsLog<CubSetT>::CubSet& CubSetReductionsLog<CubSetT>::GetShavedCubSet()
+{
+    return *_shavedCubSet;
+}
+
+template <typename CubSetT>
+typename CubSetReductionsLog<CubSetT>::CubSet& CubSetReductionsLog<CubSetT>::GetAcyclicCubSet()
+{
+    return *_acyclicCubSet;
+}
+
+template <typename CubSetT>
+size_t CubSetReductionsLog<CubSetT>::GetPosition(const int* coords) const
+{
+    size_t position = 0;
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        position += static_cast<size_t>(coords[dim]) * _strides[dim];
+    }
+    return position;
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::GetCoords(size_t position, int* coords) const
+{
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        coords[dim] = static_cast<int>(position % _widths[dim]);
+        position /= _widths[dim];
+    }
+}
+
+template <typename CubSetT>
+bool CubSetReductionsLog<CubSetT>::IsShaved(const int* coords, size_t position)
+{
+    return _steps[position] > 0 && !Iterator(*_shavedCubSet, coords).getBit()
+           && Iterator(*_inputCubSet, coords).getBit();
+}
+
+template <typename CubSetT>
+bool CubSetReductionsLog<CubSetT>::IsShavingValid(const int* coords, Step step)
+{
+    // the cube and its neighbours shaved after it are put back for the check
+    int neighbourCoords[DIM];
+    _toggled.clear();
+    for (int k = 0; k < _neighboursCount; k++)
+    {
+        if (!GetNeighbour(coords, k, neighbourCoords))
+        {
+            continue;
+        }
+        size_t position = GetPosition(neighbourCoords);
+        if (_steps[position] > step && IsShaved(neighbourCoords, position))
+        {
+            Iterator(*_shavedCubSet, neighbourCoords).setBit();
+            _toggled.push_back(position);
+        }
+    }
+    Iterator it = Iterator(*_shavedCubSet, coords);
+    it.setBit();
+    bool valid = CubSet::neighbAcyclicBI(it);
+    it.clearBit();
+    for (size_t i = 0; i < _toggled.size(); i++)
+    {
+        GetCoords(_toggled[i], neighbourCoords);
+        Iterator(*_shavedCubSet, neighbourCoords).clearBit();
+    }
+    return valid;
+}
+
+template <typename CubSetT>
+bool CubSetReductionsLog<CubSetT>::IsAddingValid(const int* coords, size_t position, Step step)
+{
+    if (position == _seed)
+    {
+        return true;
+    }
+    // neighbours added after the cube are taken away for the check
+    int neighbourCoords[DIM];
+    _toggled.clear();
+    for (int k = 0; k < _neighboursCount; k++)
+    {
+        if (!GetNeighbour(coords, k, neighbourCoords))
+        {
+            continue;
+        }
+        size_t neighbour = GetPosition(neighbourCoords);
+        Iterator neighbourIt = Iterator(*_acyclicCubSet, neighbourCoords);
+        if (_steps[neighbour] > step && neighbourIt.getBit())
+        {
+            neighbourIt.clearBit();
+            _toggled.push_back(neighbour);
+        }
+    }
+    Iterator it = Iterator(*_acyclicCubSet, coords);
+    bool valid = HasNeighbour(*_acyclicCubSet, coords) && CubSet::neighbAcyclicBI(it);
+    for (size_t i = 0; i < _toggled.size(); i++)
+    {
+        GetCoords(_toggled[i], neighbourCoords);
+        Iterator(*_acyclicCubSet, neighbourCoords).setBit();
+    }
+    return valid;
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::Restore(const int* coords, size_t position, StepsQueue& shavedQueue)
+{
+    // neighbours shaved later were shaved without the cube
+    Step step = _steps[position];
+    Iterator(*_shavedCubSet, coords).setBit();
+    _steps[position] = 0;
+    QueueShaved(coords, step, std::numeric_limits<Step>::max(), shavedQueue);
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::Undo(const int* coords, size_t position, StepsQueue& acyclicQueue)
+{
+    // neighbours added later were added next to the cube
+    Step step = _steps[position];
+    Iterator(*_acyclicCubSet, coords).clearBit();
+    _steps[position] = 0;
+    _acyclicCount--;
+    if (position == _seed)
+    {
+        _seed = NO_POSITION;
+    }
+    QueueAcyclic(coords, step, acyclicQueue);
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::QueueShaved(const int* coords, Step after, Step before, StepsQueue& queue)
+{
+    int neighbourCoords[DIM];
+    for (int k = 0; k < _neighboursCount; k++)
+    {
+        if (!GetNeighbour(coords, k, neighbourCoords))
+        {
+            continue;
+        }
+        size_t position = GetPosition(neighbourCoords);
+        Step step = _steps[position];
+        if (step > after && step < before && IsShaved(neighbourCoords, position))
+        {
+            queue.push(StepPosition(step, position));
+        }
+    }
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::QueueAcyclic(const int* coords, Step after, StepsQueue& queue)
+{
+    int neighbourCoords[DIM];
+    for (int k = 0; k < _neighboursCount; k++)
+    {
+        if (!GetNeighbour(coords, k, neighbourCoords))
+        {
+            continue;
+        }
+        size_t position = GetPosition(neighbourCoords);
+        Step step = _steps[position];
+        if (step > after && Iterator(*_acyclicCubSet, neighbourCoords).getBit())
+        {
+            queue.push(StepPosition(step, position));
+        }
+    }
+}
+
+template <typename CubSetT>
+template <typename Container>
+void CubSetReductionsLog<CubSetT>::QueueNeighbourhood(const int* coords, Container& candidates)
+{
+    int neighbourCoords[DIM];
+    for (int k = 0; k < _neighboursCount; k++)
+    {
+        if (GetNeighbour(coords, k, neighbourCoords))
+        {
+            candidates.push_back(GetPosition(neighbourCoords));
+        }
+    }
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::Shave(Positions& candidates, Positions* changed)
+{
+    int coords[DIM];
+    while (!candidates.empty())
+    {
+        size_t position = candidates.back();
+        candidates.pop_back();
+        GetCoords(position, coords);
+        Iterator it = Iterator(*_shavedCubSet, coords);
+        // cubes of the acyclic subset are not shaved, so that it stays
+        // a part of the shaved set
+        if (!it.getBit() || Iterator(*_acyclicCubSet, coords).getBit() || !CubSet::neighbAcyclicBI(it))
+        {
+            continue;
+        }
+        it.clearBit();
+        _steps[position] = NextStep();
+        if (changed != 0)
+        {
+            changed->push_back(position);
+        }
+        QueueNeighbourhood(coords, candidates);
+    }
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::Grow(Positions& candidates, Positions* changed)
+{
+    // breadth first, so that the subset grows evenly around the seed
+    std::deque<size_t> queue(candidates.begin(), candidates.end());
+    Positions().swap(candidates);
+    int coords[DIM];
+    if (_acyclicCount == 0)
+    {
+        if (!FindSeed(coords))
+        {
+            return;
+        }
+        _seed = GetPosition(coords);
+        Iterator(*_acyclicCubSet, coords).setBit();
+        _steps[_seed] = NextStep();
+        _acyclicCount++;
+        if (changed != 0)
+        {
+            changed->push_back(_seed);
+        }
+        QueueNeighbourhood(coords, queue);
+    }
+    while (!queue.empty())
+    {
+        size_t position = queue.front();
+        queue.pop_front();
+        GetCoords(position, coords);
+        Iterator it = Iterator(*_acyclicCubSet, coords);
+        if (it.getBit() || !Iterator(*_shavedCubSet, coords).getBit()
+            || !HasNeighbour(*_acyclicCubSet, coords))
+        {
+            continue;
+        }
+        it.setBit();
+        if (!CubSet::neighbAcyclicBI(it))
+        {
+            it.clearBit();
+            continue;
+        }
+        _steps[position] = NextStep();
+        _acyclicCount++;
+        if (changed != 0)
+        {
+            changed->push_back(position);
+        }
+        // rejected neighbours are tried again, as the cube may make them acyclic
+        QueueNeighbourhood(coords, queue);
+    }
+}
+
+template <typename CubSetT>
+bool CubSetReductionsLog<CubSetT>::FindSeed(int* coords)
+{
+    size_t totalCount = _steps.size();
+    std::fill(coords, coords + DIM, 0);
+    Iterator it = Iterator(*_shavedCubSet, coords);
+    for (size_t i = 0; i < totalCount; i++)
+    {
+        if (it.getBit())
+        {
+            return true;
+        }
+        NextCoords(it, coords);
+    }
+    return false;
+}
+
+template <typename CubSetT>
+bool CubSetReductionsLog<CubSetT>::HasNeighbour(CubSet& cubSet, const int* coords)
+{
+    int neighbourCoords[DIM];
+    for (int k = 0; k < _neighboursCount; k++)
+    {
+        if (GetNeighbour(coords, k, neighbourCoords) && Iterator(cubSet, neighbourCoords).getBit())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename CubSetT>
+bool CubSetReductionsLog<CubSetT>::GetNeighbour(const int* coords, int index, int* neighbourCoords) const
+{
+    const int* offsets = &_neighbourOffsets[index * DIM];
+    for (int dim = 0; dim < DIM; dim++)
+    {
+        neighbourCoords[dim] = coords[dim] + offsets[dim];
+        if (neighbourCoords[dim] < 0 || neighbourCoords[dim] >= _widths[dim])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename CubSetT>
+typename CubSetReductionsLog<CubSetT>::Step CubSetReductionsLog<CubSetT>::NextStep()
+{
+    if (_lastStep == std::numeric_limits<Step>::max() - 1)
+    {
+        RenumberSteps();
+    }
+    return ++_lastStep;
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::RenumberSteps()
+{
+    // only the order of the steps matters, so they are numbered again
+    // without the gaps left by the undone steps
+    std::vector<StepPosition> steps;
+    for (size_t i = 0; i < _steps.size(); i++)
+    {
+        if (_steps[i] > 0)
+        {
+            steps.push_back(StepPosition(_steps[i], i));
+        }
+    }
+    if (steps.size() >= std::numeric_limits<Step>::max() - 1)
+    {
+        throw std::runtime_error("too many shaved and acyclic cubes");
+    }
+    std::sort(steps.begin(), steps.end());
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        _steps[steps[i].second] = static_cast<Step>(i + 1);
+    }
+    _lastStep = static_cast<Step>(steps.size());
+}
+
+template <typename CubSetT>
+void CubSetReductionsLog<CubSetT>::NextCoords(Iterator& it, int* coords) const
+{
+    int dim = 0;
+    bool ok = false;
+    while (!ok && dim < DIM)
+    {
+        coords[dim]++;
+        it.incInDir(dim);
+        if (coords[dim] < _widths[dim])
+        {
+            ok = true;
+        }
+        else
+        {
+            it.decInDir(dim, _widths[dim]);
+            coords[dim] = 0;
+            dim++;
+        }
+    }
+}
+
+#endif	/* CUBSETREDUCTIONSLOG_HPP */
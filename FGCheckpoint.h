@@ -0,0 +1,93 @@
+/*
+ * File:   FGCheckpoint.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef FGCHECKPOINT_H
+#define	FGCHECKPOINT_H
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "WordArena.h"
+
+// Binary checkpoint of the complex supplier output: reduced cells by
+// dimension, boundaries of 1-cells and homotopic boundaries of 2-cells.
+// A checkpoint is valid only for the input file and the pipeline options
+// it was created with (both are hashed into its key). Checkpoints are
+// read through mmap, so words are appended straight from the mapping.
+template <typename IdT>
+class FGCheckpoint
+{
+public:
+
+    typedef IdT                                 Id;
+    typedef std::set<Id>                        Cells;
+    typedef std::vector<Cells>                  CellsByDim;
+    typedef std::vector<std::pair<Id, int> >    Chain;
+    typedef std::map<Id, Chain>                 Boundaries;
+    typedef WordArena<Id>                       Chains;
+
+    struct Key
+    {
+        boost::uint64_t _inputHash;
+        boost::uint64_t _optionsHash;
+    };
+
+    // options should describe everything the supplier output depends on
+    static bool CreateKey(const char* inputFilename, const std::string& options, Key& key);
+
+    // returns false if there is no checkpoint, its key does not match or
+    // the file is corrupted, the outputs are changed only on success
+    static bool Load(const char* filename, const Key& key, CellsByDim& cellsByDim,
+                     Boundaries& _1Boundaries, Chains& _2Boundaries);
+    static bool Save(const char* filename, const Key& key, const CellsByDim& cellsByDim,
+                     const Boundaries& _1Boundaries, const Chains& _2Boundaries);
+
+private:
+
+    // read-only mapping of the whole file
+    class MappedFile
+    {
+    public:
+
+        explicit MappedFile(const char* filename);
+        ~MappedFile();
+
+        bool IsOpen() const;
+        // number of bytes not read yet
+        size_t Remaining() const;
+        // returns pointer to the next count values of type T or null
+        // if the file is too short
+        template <typename T>
+        const T* Read(size_t count);
+
+    private:
+
+        MappedFile(const MappedFile&);
+        MappedFile& operator=(const MappedFile&);
+
+        const char* _data;
+        size_t      _size;
+        size_t      _position;
+    };
+
+    static const boost::uint32_t MAGIC = 0x50434746;   // "FGCP"
+    static const boost::uint32_t VERSION = 1;
+
+    // FNV-1a
+    static boost::uint64_t Hash(const char* data, size_t size, boost::uint64_t hash);
+
+    template <typename T>
+    static void Write(std::ostream& output, const T* values, size_t count);
+};
+
+#include "FGCheckpoint.hpp"
+
+#endif	/* FGCHECKPOINT_H */
@@ -0,0 +1,287 @@
+/*
+ * File:   FGCheckpoint.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef FGCHECKPOINT_HPP
+#define	FGCHECKPOINT_HPP
+
+#include "FGCheckpoint.h"
+
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename IdT>
+FGCheckpoint<IdT>::MappedFile::MappedFile(const char* filename)
+    : _data(0)
+    , _size(0)
+    , _position(0)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        void* data = mmap(0, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            _data = static_cast<const char*>(data);
+            _size = static_cast<size_t>(status.st_size);
+        }
+    }
+    close(fd);
+}
+
+template <typename IdT>
+FGCheckpoint<IdT>::MappedFile::~MappedFile()
+{
+    if (_data != 0)
+    {
+        munmap(const_cast<char*>(_data), _size);
+    }
+}
+
+template <typename IdT>
+bool FGCheckpoint<IdT>::MappedFile::IsOpen() const
+{
+    return _data != 0;
+}
+
+template <typename IdT>
+size_t FGCheckpoint<IdT>::MappedFile::Remaining() const
+{
+    return _size - _position;
+}
+
+template <typename IdT>
+template <typename T>
+const T* FGCheckpoint<IdT>::MappedFile::Read(size_t count)
+{
+    // all the values are written with their natural alignment
+    size_t alignment = sizeof(T);
+    size_t position = (_position + alignment - 1) / alignment * alignment;
+    if (_data == 0 || position > _size || count > (_size - position) / sizeof(T))
+    {
+        return 0;
+    }
+    _position = position + count * sizeof(T);
+    return reinterpret_cast<const T*>(_data + position);
+}
+
+template <typename IdT>
+bool FGCheckpoint<IdT>::CreateKey(const char* inputFilename, const std::string& options, Key& key)
+{
+    std::ifstream input(inputFilename, std::ios::binary);
+    if (!input.is_open())
+    {
+        return false;
+    }
+    boost::uint64_t hash = 14695981039346656037ULL;
+    std::vector<char> buffer(1 << 16);
+    while (input)
+    {
+        input.read(&buffer[0], buffer.size());
+        hash = Hash(&buffer[0], static_cast<size_t>(input.gcount()), hash);
+    }
+    key._inputHash = hash;
+    key._optionsHash = Hash(options.data(), options.size(), 14695981039346656037ULL);
+    return true;
+}
+
+template <typename IdT>
+bool FGCheckpoint<IdT>::Load(const char* filename, const Key& key, CellsByDim& cellsByDim,
+                             Boundaries& _1Boundaries, Chains& _2Boundaries)
+{
+    typedef typename Chains::Letter Letter;
+    MappedFile file(filename);
+    if (!file.IsOpen())
+    {
+        return false;
+    }
+
+    // magic, version, sizeof(Id), sizeof(Letter)
+    const boost::uint32_t* header = file.template Read<boost::uint32_t>(4);
+    if (header == 0 || header[0] != MAGIC || header[1] != VERSION
+        || header[2] != sizeof(Id) || header[3] != sizeof(Letter))
+    {
+        return false;
+    }
+    const boost::uint64_t* hashes = file.template Read<boost::uint64_t>(2);
+    if (hashes == 0 || hashes[0] != key._inputHash || hashes[1] != key._optionsHash)
+    {
+        return false;
+    }
+
+    // counts are checked against the remaining bytes before anything
+    // is allocated, every dimension takes at least its cells count
+    const boost::uint64_t* dimsCount = file.template Read<boost::uint64_t>(1);
+    if (dimsCount == 0 || *dimsCount > file.Remaining() / sizeof(boost::uint64_t))
+    {
+        return false;
+    }
+    CellsByDim loadedCellsByDim(static_cast<size_t>(*dimsCount));
+    for (size_t dim = 0; dim < loadedCellsByDim.size(); dim++)
+    {
+        const boost::uint64_t* cellsCount = file.template Read<boost::uint64_t>(1);
+        const Id* cells = cellsCount ? file.template Read<Id>(static_cast<size_t>(*cellsCount)) : 0;
+        if (cells == 0)
+        {
+            return false;
+        }
+        // cells were written in order, so every insertion is at the end
+        for (size_t i = 0; i < *cellsCount; i++)
+        {
+            loadedCellsByDim[dim].insert(loadedCellsByDim[dim].end(), cells[i]);
+        }
+    }
+
+    // every boundary takes at least its cell and its length
+    const boost::uint64_t* boundariesCount = file.template Read<boost::uint64_t>(1);
+    if (boundariesCount == 0 || *boundariesCount > file.Remaining() / (sizeof(Id) + sizeof(boost::uint64_t)))
+    {
+        return false;
+    }
+    Boundaries loaded1Boundaries;
+    for (size_t i = 0; i < *boundariesCount; i++)
+    {
+        const Id* cell = file.template Read<Id>(1);
+        const boost::uint64_t* length = cell ? file.template Read<boost::uint64_t>(1) : 0;
+        const Id* faces = length ? file.template Read<Id>(static_cast<size_t>(*length)) : 0;
+        const boost::int32_t* coefficients = faces ? file.template Read<boost::int32_t>(static_cast<size_t>(*length)) : 0;
+        if (coefficients == 0)
+        {
+            return false;
+        }
+        Chain& boundary = loaded1Boundaries[*cell];
+        for (size_t j = 0; j < *length; j++)
+        {
+            boundary.push_back(std::make_pair(faces[j], static_cast<int>(coefficients[j])));
+        }
+    }
+
+    const boost::uint64_t* counts = file.template Read<boost::uint64_t>(2);
+    const boost::uint64_t* lengths = counts ? file.template Read<boost::uint64_t>(static_cast<size_t>(counts[0])) : 0;
+    const Letter* letters = lengths ? file.template Read<Letter>(static_cast<size_t>(counts[1])) : 0;
+    if (letters == 0)
+    {
+        return false;
+    }
+    Chains loaded2Boundaries;
+    loaded2Boundaries.Reserve(static_cast<size_t>(counts[0]), static_cast<size_t>(counts[1]));
+    const Letter* lettersEnd = letters + counts[1];
+    for (size_t i = 0; i < counts[0]; i++)
+    {
+        if (lengths[i] > static_cast<size_t>(lettersEnd - letters))
+        {
+            return false;
+        }
+        loaded2Boundaries.Append(letters, letters + lengths[i]);
+        loaded2Boundaries.EndWord();
+        letters += lengths[i];
+    }
+
+    // the whole file is valid
+    cellsByDim.swap(loadedCellsByDim);
+    _1Boundaries.swap(loaded1Boundaries);
+    _2Boundaries.Swap(loaded2Boundaries);
+    return true;
+}
+
+template <typename IdT>
+bool FGCheckpoint<IdT>::Save(const char* filename, const Key& key, const CellsByDim& cellsByDim,
+                             const Boundaries& _1Boundaries, const Chains& _2Boundaries)
+{
+    typedef typename Chains::Letter Letter;
+    std::ofstream output(filename, std::ios::binary);
+    if (!output.is_open())
+    {
+        return false;
+    }
+
+    boost::uint32_t header[] = { MAGIC, VERSION, sizeof(Id), sizeof(Letter) };
+    Write(output, header, 4);
+    boost::uint64_t hashes[] = { key._inputHash, key._optionsHash };
+    Write(output, hashes, 2);
+
+    boost::uint64_t count = cellsByDim.size();
+    Write(output, &count, 1);
+    for (size_t dim = 0; dim < cellsByDim.size(); dim++)
+    {
+        std::vector<Id> cells(cellsByDim[dim].begin(), cellsByDim[dim].end());
+        count = cells.size();
+        Write(output, &count, 1);
+        Write(output, cells.empty() ? 0 : &cells[0], cells.size());
+    }
+
+    count = _1Boundaries.size();
+    Write(output, &count, 1);
+    typename Boundaries::const_iterator it = _1Boundaries.begin();
+    typename Boundaries::const_iterator itEnd = _1Boundaries.end();
+    for ( ; it != itEnd; ++it)
+    {
+        const Chain& boundary = it->second;
+        std::vector<Id> faces(boundary.size());
+        std::vector<boost::int32_t> coefficients(boundary.size());
+        for (size_t i = 0; i < boundary.size(); i++)
+        {
+            faces[i] = boundary[i].first;
+            coefficients[i] = static_cast<boost::int32_t>(boundary[i].second);
+        }
+        Write(output, &it->first, 1);
+        count = boundary.size();
+        Write(output, &count, 1);
+        Write(output, faces.empty() ? 0 : &faces[0], faces.size());
+        Write(output, coefficients.empty() ? 0 : &coefficients[0], coefficients.size());
+    }
+
+    boost::uint64_t counts[] = { _2Boundaries.WordsCount(), _2Boundaries.LettersCount() };
+    Write(output, counts, 2);
+    std::vector<boost::uint64_t> lengths(_2Boundaries.WordsCount());
+    for (size_t i = 0; i < lengths.size(); i++)
+    {
+        lengths[i] = _2Boundaries.WordLength(i);
+    }
+    Write(output, lengths.empty() ? 0 : &lengths[0], lengths.size());
+    for (size_t i = 0; i < _2Boundaries.WordsCount(); i++)
+    {
+        Write(output, _2Boundaries.WordBegin(i), _2Boundaries.WordLength(i));
+    }
+    return output.good();
+}
+
+template <typename IdT>
+boost::uint64_t FGCheckpoint<IdT>::Hash(const char* data, size_t size, boost::uint64_t hash)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <typename IdT>
+template <typename T>
+void FGCheckpoint<IdT>::Write(std::ostream& output, const T* values, size_t count)
+{
+    // padding to the natural alignment of T (see MappedFile::Read)
+    static const char padding[sizeof(T)] = { 0 };
+    size_t position = static_cast<size_t>(output.tellp());
+    size_t misalignment = position % sizeof(T);
+    if (misalignment > 0)
+    {
+        output.write(padding, sizeof(T) - misalignment);
+    }
+    if (count > 0)
+    {
+        output.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+    }
+}
+
+#endif	/* FGCHECKPOINT_HPP */
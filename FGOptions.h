@@ -0,0 +1,68 @@
+/*
+ * File:   FGOptions.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef FGOPTIONS_H
+#define	FGOPTIONS_H
+
+#include <string>
+#include <vector>
+
+// order of cells in which coreductions look for aces (see CellsOrder)
+enum OrderPolicy
+{
+    OP_Default,
+    OP_LowestDegree,
+    OP_BoundaryBFS,
+    OP_Random,
+};
+
+struct FGOptions
+{
+    // compute abelian invariants of the group without external tools
+    bool    _abelianInvariants;
+    // threads used for computing homotopic boundaries of 2-cells and
+    // for building cubical quotient complexes, 0 means one thread per core
+    int     _threadsCount;
+    // file for homotopic paths statistics (not written if empty)
+    std::string _statsFilename;
+    // cells of greater dimension are discarded while loading kappa maps
+    // and simplices (fundamental group depends only on the 2-skeleton),
+    // -1 means no limit, otherwise it has to be at least 2
+    int     _skeletonDim;
+    // eliminate generators by Tietze transformations until no generator
+    // can be removed without making relators longer
+    bool    _iterateReductions;
+    // order of cells of complexes created from kappa maps
+    OrderPolicy _orderPolicy;
+    // number of random orders tried (the one leaving the least
+    // extracted cells is kept), used only with OP_Random
+    int     _orderRestarts;
+    // intermediate data (complexes, coreduction algorithm, homotopic
+    // boundaries) are released as soon as the next phase does not need them
+    bool    _leanMemory;
+    // checkpoint of the cells and homotopic boundaries of the complex,
+    // loaded instead of reducing the input again if the input and the
+    // options match (not used if empty)
+    std::string _checkpointFilename;
+    // cubical suppliers keep the (not shaved) input set, so that cubes
+    // can be inserted or removed and the complex recomputed
+    bool    _editable;
+    // sublevel sets of grayscale inputs (see GrayscaleVolume) are taken
+    // for the first threshold, the others are used by the sweep
+    std::vector<int> _thresholds;
+
+    FGOptions()
+        : _abelianInvariants(false)
+        , _threadsCount(1)
+        , _skeletonDim(-1)
+        , _iterateReductions(false)
+        , _orderPolicy(OP_Default)
+        , _orderRestarts(1)
+        , _leanMemory(false)
+        , _editable(false)
+    {}
+};
+
+#endif	/* FGOPTIONS_H */
@@ -0,0 +1,109 @@
+/*
+ * File:   FreeWord.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef FREEWORD_H
+#define	FREEWORD_H
+
+#include <cstddef>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+// Freely reduced word of a free group kept as a rope. Words are immutable
+// views (range + orientation) of shared nodes, each node is either a flat
+// run of letters or a concatenation of two other words, so concatenation,
+// inversion and slicing never copy letters. Letters are signed integers,
+// x^-1 is -x (the encoding of WordArena).
+template <typename LetterT = int>
+class FreeWord
+{
+public:
+
+    typedef LetterT                     Letter;
+    typedef std::vector<Letter>         Letters;
+
+    // empty word
+    FreeWord();
+    explicit FreeWord(Letter letter);
+    // letters are freely reduced first
+    explicit FreeWord(const Letters& letters);
+
+    size_t Length() const;
+    bool Empty() const;
+    Letter At(size_t index) const;
+    Letter Front() const;
+    Letter Back() const;
+
+    FreeWord Inverse() const;
+    FreeWord Slice(size_t begin, size_t end) const;
+    FreeWord Power(int exponent) const;
+    // reduced product: common part at the join is cut off
+    static FreeWord Concat(const FreeWord& a, const FreeWord& b);
+
+    // calls visitor(letter) for all the letters in order
+    template <typename Visitor>
+    void Visit(Visitor& visitor) const;
+    // appends all the letters to the vector
+    void GetLetters(Letters& letters) const;
+
+    // true if both words are views of the same node
+    bool SharesNode(const FreeWord& other) const;
+    // memory used by the top node of the word (not by its subwords)
+    size_t NodeBytes() const;
+
+private:
+
+    struct Node;
+    typedef boost::shared_ptr<const Node>   NodePtr;
+
+    // words not longer than this are kept flat (in one node)
+    static const size_t LEAF_SIZE = 32;
+    // deeper ropes are rebalanced, so that At() stays cheap
+    static const size_t MAX_DEPTH = 64;
+
+    // part of a word to be visited (in the coordinates of the node)
+    struct VisitFrame
+    {
+        const Node* node;
+        size_t      begin;
+        size_t      end;
+        bool        inverted;
+
+        VisitFrame(const Node* node, size_t begin, size_t end, bool inverted)
+            : node(node)
+            , begin(begin)
+            , end(end)
+            , inverted(inverted)
+        {}
+    };
+
+    FreeWord(NodePtr node, size_t offset, size_t length, bool inverted);
+
+    static void PushFrame(std::vector<VisitFrame>& stack, const FreeWord& word,
+                          size_t begin, size_t end, bool inverted);
+    // concatenation node of two nonempty words (without cancellation)
+    static FreeWord Join(const FreeWord& left, const FreeWord& right);
+    // join keeping the rope balanced: a much deeper word is descended
+    // (as in AVL trees), so that the result is not deeper than needed
+    static FreeWord BalancedJoin(const FreeWord& left, const FreeWord& right);
+    // subwords of a view of a whole concatenation node, false for leaves
+    // and slices
+    static bool Split(const FreeWord& word, FreeWord& left, FreeWord& right);
+    // balanced rope of the same letters built from the leaves of the word,
+    // used when slices make the rope too deep anyway
+    static FreeWord Rebalance(const FreeWord& word);
+    static size_t Depth(const FreeWord& word);
+
+    NodePtr     _node;
+    size_t      _offset;
+    size_t      _length;
+    bool        _inverted;
+    // cached, so that joins without cancellation take constant time
+    Letter      _front;
+    Letter      _back;
+};
+
+#include "FreeWord.hpp"
+
+#endif	/* FREEWORD_H */
@@ -0,0 +1,547 @@
+/*
+ * File:   FreeWord.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef FREEWORD_HPP
+#define	FREEWORD_HPP
+
+#include "FreeWord.h"
+
+#include <algorithm>
+#include <cassert>
+
+template <typename LetterT>
+struct FreeWord<LetterT>::Node
+{
+    // flat run of letters (never empty)
+    Letters     letters;
+    // or concatenation of two nonempty words
+    FreeWord    left;
+    FreeWord    right;
+    // 0 for leaves
+    size_t      depth;
+
+    Node()
+        : depth(0)
+    {}
+
+    // subwords are released iteratively, a recursive release of a deep
+    // rope could overflow the stack
+    ~Node()
+    {
+        std::vector<NodePtr> stack;
+        Detach(stack);
+        while (!stack.empty())
+        {
+            NodePtr node = stack.back();
+            stack.pop_back();
+            if (node.unique())
+            {
+                // nobody else refers to the node, so its subwords
+                // can be taken before it is released
+                const_cast<Node*>(node.get())->Detach(stack);
+            }
+        }
+    }
+
+    void Detach(std::vector<NodePtr>& stack)
+    {
+        if (left._node)
+        {
+            stack.push_back(left._node);
+            left._node.reset();
+        }
+        if (right._node)
+        {
+            stack.push_back(right._node);
+            right._node.reset();
+        }
+    }
+
+    bool IsLeaf() const
+    {
+        return letters.size() > 0;
+    }
+};
+
+template <typename LetterT>
+FreeWord<LetterT>::FreeWord()
+    : _offset(0)
+    , _length(0)
+    , _inverted(false)
+    , _front(0)
+    , _back(0)
+{
+}
+
+template <typename LetterT>
+FreeWord<LetterT>::FreeWord(Letter letter)
+    : _offset(0)
+    , _length(1)
+    , _inverted(false)
+    , _front(letter)
+    , _back(letter)
+{
+    assert(letter != 0);
+    boost::shared_ptr<Node> node(new Node());
+    node->letters.push_back(letter);
+    _node = node;
+}
+
+template <typename LetterT>
+FreeWord<LetterT>::FreeWord(const Letters& letters)
+    : _offset(0)
+    , _length(0)
+    , _inverted(false)
+    , _front(0)
+    , _back(0)
+{
+    // stack-based reduction
+    boost::shared_ptr<Node> node(new Node());
+    typename Letters::const_iterator it = letters.begin();
+    typename Letters::const_iterator itEnd = letters.end();
+    for ( ; it != itEnd; ++it)
+    {
+        assert(*it != 0);
+        if (node->letters.size() > 0 && node->letters.back() == -*it)
+        {
+            node->letters.pop_back();
+        }
+        else
+        {
+            node->letters.push_back(*it);
+        }
+    }
+    if (node->letters.size() > 0)
+    {
+        _length = node->letters.size();
+        _front = node->letters.front();
+        _back = node->letters.back();
+        _node = node;
+    }
+}
+
+template <typename LetterT>
+FreeWord<LetterT>::FreeWord(NodePtr node, size_t offset, size_t length, bool inverted)
+    : _node(node)
+    , _offset(offset)
+    , _length(length)
+    , _inverted(inverted)
+    , _front(0)
+    , _back(0)
+{
+    if (_length > 0)
+    {
+        _front = At(0);
+        _back = At(_length - 1);
+    }
+    else
+    {
+        _node.reset();
+        _offset = 0;
+        _inverted = false;
+    }
+}
+
+template <typename LetterT>
+size_t FreeWord<LetterT>::Length() const
+{
+    return _length;
+}
+
+template <typename LetterT>
+bool FreeWord<LetterT>::Empty() const
+{
+    return _length == 0;
+}
+
+template <typename LetterT>
+typename FreeWord<LetterT>::Letter
+FreeWord<LetterT>::At(size_t index) const
+{
+    assert(index < _length);
+    size_t i = _inverted ? _offset + _length - 1 - index : _offset + index;
+    bool inverted = _inverted;
+    const Node* node = _node.get();
+    while (!node->IsLeaf())
+    {
+        size_t leftLength = node->left._length;
+        const FreeWord& child = i < leftLength ? node->left : node->right;
+        if (i >= leftLength)
+        {
+            i -= leftLength;
+        }
+        i = child._inverted ? child._offset + child._length - 1 - i : child._offset + i;
+        inverted = (inverted != child._inverted);
+        node = child._node.get();
+    }
+    assert(i < node->letters.size());
+    return inverted ? -node->letters[i] : node->letters[i];
+}
+
+template <typename LetterT>
+typename FreeWord<LetterT>::Letter
+FreeWord<LetterT>::Front() const
+{
+    assert(_length > 0);
+    return _front;
+}
+
+template <typename LetterT>
+typename FreeWord<LetterT>::Letter
+FreeWord<LetterT>::Back() const
+{
+    assert(_length > 0);
+    return _back;
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::Inverse() const
+{
+    FreeWord inverse(*this);
+    inverse._inverted = !_inverted;
+    inverse._front = -_back;
+    inverse._back = -_front;
+    return inverse;
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::Slice(size_t begin, size_t end) const
+{
+    assert(begin <= end && end <= _length);
+    size_t offset = _inverted ? _offset + _length - end : _offset + begin;
+    return FreeWord(_node, offset, end - begin, _inverted);
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::Power(int exponent) const
+{
+    if (exponent == 0)
+    {
+        return FreeWord();
+    }
+    FreeWord base = exponent > 0 ? *this : Inverse();
+    FreeWord result = base;
+    int count = exponent > 0 ? exponent : -exponent;
+    for (int i = 1; i < count; i++)
+    {
+        result = Concat(result, base);
+    }
+    return result;
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::Concat(const FreeWord& a, const FreeWord& b)
+{
+    if (a.Empty())
+    {
+        return b;
+    }
+    if (b.Empty())
+    {
+        return a;
+    }
+
+    // cancellation at the join
+    size_t common = 0;
+    if (a._back == -b._front)
+    {
+        common = 1;
+        size_t maxCommon = std::min(a._length, b._length);
+        while (common < maxCommon && a.At(a._length - 1 - common) == -b.At(common))
+        {
+            common++;
+        }
+    }
+    FreeWord left = common > 0 ? a.Slice(0, a._length - common) : a;
+    FreeWord right = common > 0 ? b.Slice(common, b._length) : b;
+    if (left.Empty())
+    {
+        return right;
+    }
+    if (right.Empty())
+    {
+        return left;
+    }
+
+    FreeWord result = BalancedJoin(left, right);
+    return Depth(result) > MAX_DEPTH ? Rebalance(result) : result;
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::BalancedJoin(const FreeWord& left, const FreeWord& right)
+{
+    FreeWord first;
+    FreeWord second;
+    if (Depth(left) > Depth(right) + 1 && Split(left, first, second))
+    {
+        // right is joined to the right subword of left
+        FreeWord joined = BalancedJoin(second, right);
+        if (Depth(joined) <= Depth(first) + 1)
+        {
+            return Join(first, joined);
+        }
+        FreeWord joinedFirst;
+        FreeWord joinedSecond;
+        if (!Split(joined, joinedFirst, joinedSecond))
+        {
+            return Join(first, joined);
+        }
+        FreeWord innerFirst;
+        FreeWord innerSecond;
+        if (Depth(joinedFirst) > Depth(joinedSecond) && Split(joinedFirst, innerFirst, innerSecond))
+        {
+            // double rotation
+            return Join(Join(first, innerFirst), Join(innerSecond, joinedSecond));
+        }
+        // single rotation
+        return Join(Join(first, joinedFirst), joinedSecond);
+    }
+    if (Depth(right) > Depth(left) + 1 && Split(right, first, second))
+    {
+        // mirror image of the above
+        FreeWord joined = BalancedJoin(left, first);
+        if (Depth(joined) <= Depth(second) + 1)
+        {
+            return Join(joined, second);
+        }
+        FreeWord joinedFirst;
+        FreeWord joinedSecond;
+        if (!Split(joined, joinedFirst, joinedSecond))
+        {
+            return Join(joined, second);
+        }
+        FreeWord innerFirst;
+        FreeWord innerSecond;
+        if (Depth(joinedSecond) > Depth(joinedFirst) && Split(joinedSecond, innerFirst, innerSecond))
+        {
+            return Join(Join(joinedFirst, innerFirst), Join(innerSecond, second));
+        }
+        return Join(joinedFirst, Join(joinedSecond, second));
+    }
+    return Join(left, right);
+}
+
+template <typename LetterT>
+bool FreeWord<LetterT>::Split(const FreeWord& word, FreeWord& left, FreeWord& right)
+{
+    const Node* node = word._node.get();
+    if (node == 0 || node->IsLeaf() || word._offset != 0
+        || word._length != node->left._length + node->right._length)
+    {
+        return false;
+    }
+    if (word._inverted)
+    {
+        left = node->right.Inverse();
+        right = node->left.Inverse();
+    }
+    else
+    {
+        left = node->left;
+        right = node->right;
+    }
+    return true;
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::Join(const FreeWord& left, const FreeWord& right)
+{
+    if (left._length + right._length <= LEAF_SIZE)
+    {
+        // short words are copied to keep the rope shallow
+        Letters letters;
+        letters.reserve(left._length + right._length);
+        left.GetLetters(letters);
+        right.GetLetters(letters);
+        return FreeWord(letters);
+    }
+
+    boost::shared_ptr<Node> node(new Node());
+    node->left = left;
+    node->right = right;
+    node->depth = 1 + std::max(Depth(left), Depth(right));
+    FreeWord result;
+    result._node = node;
+    result._length = left._length + right._length;
+    result._front = left._front;
+    result._back = right._back;
+    return result;
+}
+
+template <typename LetterT>
+FreeWord<LetterT> FreeWord<LetterT>::Rebalance(const FreeWord& word)
+{
+    // views of the leaves in the order of the letters, no letter is copied
+    std::vector<FreeWord> pieces;
+    std::vector<FreeWord> stack(1, word);
+    while (!stack.empty())
+    {
+        FreeWord part = stack.back();
+        stack.pop_back();
+        if (part.Empty())
+        {
+            continue;
+        }
+        const Node* node = part._node.get();
+        if (node->IsLeaf())
+        {
+            pieces.push_back(part);
+            continue;
+        }
+        size_t leftLength = node->left._length;
+        size_t begin = part._offset;
+        size_t end = part._offset + part._length;
+        FreeWord leftPart = node->left.Slice(std::min(begin, leftLength), std::min(end, leftLength));
+        FreeWord rightPart = node->right.Slice(std::max(begin, leftLength) - leftLength,
+                                               std::max(end, leftLength) - leftLength);
+        // parts are pushed in the reversed order of visiting
+        if (part._inverted)
+        {
+            stack.push_back(leftPart.Inverse());
+            stack.push_back(rightPart.Inverse());
+        }
+        else
+        {
+            stack.push_back(rightPart);
+            stack.push_back(leftPart);
+        }
+    }
+
+    // neighbouring pieces are joined until one is left
+    while (pieces.size() > 1)
+    {
+        std::vector<FreeWord> joined;
+        joined.reserve((pieces.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < pieces.size(); i += 2)
+        {
+            joined.push_back(Join(pieces[i], pieces[i + 1]));
+        }
+        if (pieces.size() % 2 == 1)
+        {
+            joined.push_back(pieces.back());
+        }
+        pieces.swap(joined);
+    }
+    return pieces.empty() ? FreeWord() : pieces[0];
+}
+
+template <typename LetterT>
+size_t FreeWord<LetterT>::Depth(const FreeWord& word)
+{
+    return word._node ? word._node->depth : 0;
+}
+
+template <typename LetterT>
+template <typename Visitor>
+void FreeWord<LetterT>::Visit(Visitor& visitor) const
+{
+    std::vector<VisitFrame> stack;
+    PushFrame(stack, *this, 0, _length, false);
+    while (!stack.empty())
+    {
+        VisitFrame frame = stack.back();
+        stack.pop_back();
+        const Node* node = frame.node;
+        if (node->IsLeaf())
+        {
+            if (!frame.inverted)
+            {
+                for (size_t i = frame.begin; i < frame.end; i++)
+                {
+                    visitor(node->letters[i]);
+                }
+            }
+            else
+            {
+                for (size_t i = frame.end; i > frame.begin; i--)
+                {
+                    visitor(-node->letters[i - 1]);
+                }
+            }
+            continue;
+        }
+        // parts are pushed in the reversed order of visiting
+        size_t leftLength = node->left._length;
+        size_t leftEnd = std::min(frame.end, leftLength);
+        size_t rightBegin = std::max(frame.begin, leftLength) - leftLength;
+        bool hasLeft = frame.begin < leftLength;
+        bool hasRight = frame.end > leftLength;
+        if (!frame.inverted)
+        {
+            if (hasRight)
+            {
+                PushFrame(stack, node->right, rightBegin, frame.end - leftLength, false);
+            }
+            if (hasLeft)
+            {
+                PushFrame(stack, node->left, frame.begin, leftEnd, false);
+            }
+        }
+        else
+        {
+            if (hasLeft)
+            {
+                PushFrame(stack, node->left, frame.begin, leftEnd, true);
+            }
+            if (hasRight)
+            {
+                PushFrame(stack, node->right, rightBegin, frame.end - leftLength, true);
+            }
+        }
+    }
+}
+
+template <typename LetterT>
+void FreeWord<LetterT>::PushFrame(std::vector<VisitFrame>& stack, const FreeWord& word,
+                                  size_t begin, size_t end, bool inverted)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    if (word._inverted)
+    {
+        size_t last = word._offset + word._length;
+        stack.push_back(VisitFrame(word._node.get(), last - end, last - begin, !inverted));
+    }
+    else
+    {
+        stack.push_back(VisitFrame(word._node.get(), word._offset + begin, word._offset + end, inverted));
+    }
+}
+
+template <typename LetterT>
+void FreeWord<LetterT>::GetLetters(Letters& letters) const
+{
+    struct Collector
+    {
+        Letters* letters;
+
+        void operator()(Letter letter)
+        {
+            letters->push_back(letter);
+        }
+    };
+    Collector collector = { &letters };
+    Visit(collector);
+}
+
+template <typename LetterT>
+bool FreeWord<LetterT>::SharesNode(const FreeWord& other) const
+{
+    return _node == other._node;
+}
+
+template <typename LetterT>
+size_t FreeWord<LetterT>::NodeBytes() const
+{
+    if (!_node)
+    {
+        return 0;
+    }
+    return sizeof(Node) + _node->letters.capacity() * sizeof(Letter);
+}
+
+#endif	/* FREEWORD_HPP */
@@ -13,7 +13,10 @@
 #include <vector>
 #include <boost/shared_ptr.hpp>
 
+#include "FGCheckpoint.h"
 #include "FGLogger.h"
+#include "FGOptions.h"
+#include "WordArena.h"
 
 class IFundGroup
 {
@@ -39,14 +42,18 @@ public:
     typedef boost::shared_ptr<ComplexSupplier>          ComplexSupplierPtr;
 
     FundGroup();
-    FundGroup(const char *filename);
-    FundGroup(ComplexSupplierPtr complexSupplier);
-    FundGroup(DebugComplexType debugComplexType);
+    FundGroup(const char *filename, const FGOptions& options = FGOptions());
+    FundGroup(ComplexSupplierPtr complexSupplier, const FGOptions& options = FGOptions());
+    FundGroup(DebugComplexType debugComplexType, const FGOptions& options = FGOptions());
 
     void ExportHapProgram(const char* filename) const override;
     std::string HapFunctionBody() const;
     std::string HapExpression() const;
     std::vector<int> HapInterfaceVector() const;
+    const std::vector<long long>& GetAbelianInvariants() const;
+    // computes the group again, e.g. after the input of the complex
+    // supplier was edited and the supplier updated
+    void Recompute();
 
 private:
 
@@ -55,21 +62,42 @@ private:
     typedef typename ComplexSupplierType::Cells         Cells;
     typedef typename ComplexSupplierType::CellsByDim    CellsByDim;
     typedef typename ComplexSupplierType::Chain         Chain;
-    typedef std::pair<Id, int>                          RelatorComponent;
-    typedef std::vector<RelatorComponent>               Relator;
-    typedef std::vector<Relator>                        Relators;
+    typedef typename ComplexSupplierType::Chains        Chains;
+    typedef WordArena<Id>                               Relators;
+    typedef typename Relators::Letter                   Letter;
+    typedef typename Relators::LetterIterator           LetterIterator;
+    typedef typename Relators::Syllables                Syllables;
+    typedef FGCheckpoint<Id>                            Checkpoint;
 
     ComplexSupplierPtr      _complexSupplier;
     CellsByDim              _cellsByDim;
-    std::map<Id, Chain>     _2Boundaries;
+    // i-th word is a (homotopic) boundary of i-th cell in _cellsByDim[2]
+    Chains                  _2Boundaries;
+    // boundaries of 1-cells read from the checkpoint (there is
+    // no complex supplier then)
+    std::map<Id, Chain>     _1Boundaries;
     Cells                   _spanningTreeEdges;
     Relators                _relators;
+    std::vector<long long>  _abelianInvariants;
+    FGOptions               _options;
     FGLogger                _logger;
+    // key of the checkpoint to be written after the cells are computed
+    typename Checkpoint::Key _checkpointKey;
+    bool                    _saveCheckpoint;
 
     void Compute();
+    // returns true if cells data were read from the checkpoint
+    bool LoadCheckpoint(const char* filename);
+    void SaveCheckpoint();
+    Chain GetBoundary(const Id& cellId);
     void CreateSpanningTree();
     void ComputeRelators();
     void SimplifyRelators();
+    // repeats Tietze eliminations of generators (until fixpoint),
+    // returns number of generators eliminated
+    size_t EliminateGenerators();
+    void CanonicalizeRelators();
+    void ComputeAbelianInvariants();
     virtual std::string ToString() override;
 
     void PrintDebug();
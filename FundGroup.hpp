@@ -8,39 +8,82 @@
 
 #include "FundGroup.h"
 
+#include "SmithNormalForm.h"
+
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <list>
 #include <sstream>
+#include <stdexcept>
+#include <typeinfo>
 #include <vector>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
 
 template <typename ComplexSupplierType>
-FundGroup<ComplexSupplierType>::FundGroup(const char *filename)
+FundGroup<ComplexSupplierType>::FundGroup(const char *filename, const FGOptions& options)
+    : _options(options)
+    , _saveCheckpoint(false)
 {
-    _complexSupplier = ComplexSupplierPtr(new ComplexSupplier(filename));
+    // lower skeletons lose edges or 2-cells, so the group would be wrong
+    if (_options._skeletonDim != -1 && _options._skeletonDim < 2)
+    {
+        throw std::runtime_error("skeleton dimension has to be -1 or at least 2");
+    }
+    if (!LoadCheckpoint(filename))
+    {
+        _complexSupplier = ComplexSupplierPtr(new ComplexSupplier(filename, options));
+    }
     Compute();
 }
 
 template <typename ComplexSupplierType>
-FundGroup<ComplexSupplierType>::FundGroup(DebugComplexType debugComplexType)
+FundGroup<ComplexSupplierType>::FundGroup(DebugComplexType debugComplexType, const FGOptions& options)
+    : _options(options)
+    , _saveCheckpoint(false)
 {
-    _complexSupplier = ComplexSupplierPtr(new ComplexSupplier(debugComplexType));
+    _complexSupplier = ComplexSupplierPtr(new ComplexSupplier(debugComplexType, options));
     Compute();
 }
 
 template <typename ComplexSupplierType>
-FundGroup<ComplexSupplierType>::FundGroup(ComplexSupplierPtr complexSupplier)
+FundGroup<ComplexSupplierType>::FundGroup(ComplexSupplierPtr complexSupplier, const FGOptions& options)
     : _complexSupplier(complexSupplier)
+    , _options(options)
+    , _saveCheckpoint(false)
+{
+    Compute();
+}
+
+template <typename ComplexSupplierType>
+void FundGroup<ComplexSupplierType>::Recompute()
 {
+    assert(_complexSupplier);
+    _cellsByDim.clear();
+    _2Boundaries.Clear();
+    _1Boundaries.clear();
+    _spanningTreeEdges.clear();
+    _relators.Clear();
+    _abelianInvariants.clear();
     Compute();
 }
 
 template <typename ComplexSupplierType>
 void FundGroup<ComplexSupplierType>::Compute()
 {
-    _logger.Begin(FGLogger::Details, "getting cells data");
-    _complexSupplier->GetCells(_cellsByDim, _2Boundaries);
-    _logger.End();
+    if (_complexSupplier)
+    {
+        _logger.Begin(FGLogger::Details, "getting cells data");
+        _complexSupplier->GetCells(_cellsByDim, _2Boundaries);
+        _logger.End();
+        if (_saveCheckpoint)
+        {
+            // checkpoint describes only the input file
+            SaveCheckpoint();
+            _saveCheckpoint = false;
+        }
+    }
 
     if (_cellsByDim[0].size() > 1)
     {
@@ -50,11 +93,98 @@ void FundGroup<ComplexSupplierType>::Compute()
     }
     _logger.Begin(FGLogger::Details, "computing relators");
     ComputeRelators();
+    if (_options._leanMemory)
+    {
+        // relators are all that is needed from now on
+        Chains().Swap(_2Boundaries);
+        Cells().swap(_spanningTreeEdges);
+    }
+    CanonicalizeRelators();
     SimplifyRelators();
+    CanonicalizeRelators();
+    if (_options._iterateReductions && EliminateGenerators() > 0)
+    {
+        CanonicalizeRelators();
+    }
     _logger.End();
+    if (_options._abelianInvariants)
+    {
+        _logger.Begin(FGLogger::Details, "computing abelian invariants");
+        ComputeAbelianInvariants();
+        _logger.End();
+    }
     PrintDebug();
 }
 
+template <typename ComplexSupplierType>
+bool FundGroup<ComplexSupplierType>::LoadCheckpoint(const char* filename)
+{
+    if (_options._checkpointFilename.empty())
+    {
+        return false;
+    }
+    // everything the supplier output depends on
+    std::ostringstream options;
+    options<<typeid(ComplexSupplier).name()<<" "<<_options._skeletonDim;
+    options<<" "<<_options._orderPolicy<<" "<<_options._orderRestarts;
+    if (!_options._thresholds.empty())
+    {
+        // only the first threshold is used when the supplier is created
+        options<<" "<<_options._thresholds[0];
+    }
+    if (!Checkpoint::CreateKey(filename, options.str(), _checkpointKey))
+    {
+        return false;
+    }
+    _logger.Begin(FGLogger::Details, "reading checkpoint");
+    bool loaded = Checkpoint::Load(_options._checkpointFilename.c_str(), _checkpointKey,
+                                   _cellsByDim, _1Boundaries, _2Boundaries);
+    _logger.End(loaded ? "checkpoint read" : "checkpoint not found or outdated");
+    if (!loaded)
+    {
+        _cellsByDim.clear();
+        _1Boundaries.clear();
+        _2Boundaries.Clear();
+        _saveCheckpoint = true;
+    }
+    return loaded;
+}
+
+template <typename ComplexSupplierType>
+void FundGroup<ComplexSupplierType>::SaveCheckpoint()
+{
+    _logger.Begin(FGLogger::Details, "writing checkpoint");
+    std::map<Id, Chain> boundaries;
+    if (_cellsByDim.size() > 1)
+    {
+        typename Cells::iterator it = _cellsByDim[1].begin();
+        typename Cells::iterator itEnd = _cellsByDim[1].end();
+        for ( ; it != itEnd; ++it)
+        {
+            boundaries[*it] = _complexSupplier->GetBoundary(*it);
+        }
+    }
+    if (!Checkpoint::Save(_options._checkpointFilename.c_str(), _checkpointKey,
+                          _cellsByDim, boundaries, _2Boundaries))
+    {
+        _logger.Log(FGLogger::Output)<<"cannot write checkpoint to "<<_options._checkpointFilename<<std::endl;
+    }
+    _logger.End();
+}
+
+template <typename ComplexSupplierType>
+typename FundGroup<ComplexSupplierType>::Chain
+FundGroup<ComplexSupplierType>::GetBoundary(const Id& cellId)
+{
+    if (_complexSupplier)
+    {
+        return _complexSupplier->GetBoundary(cellId);
+    }
+    typename std::map<Id, Chain>::const_iterator it = _1Boundaries.find(cellId);
+    assert(it != _1Boundaries.end());
+    return it->second;
+}
+
 template <typename ComplexSupplierType>
 void FundGroup<ComplexSupplierType>::CreateSpanningTree()
 {
@@ -72,7 +202,7 @@ void FundGroup<ComplexSupplierType>::CreateSpanningTree()
         typename std::list<Id>::iterator itEnd = _1cells.end();
         while (it != itEnd)
         {
-            Chain boundary = _complexSupplier->GetBoundary(*it);
+            Chain boundary = GetBoundary(*it);
             if (boundary.size() == 2)
             {
                 typename Chain::iterator cit = boundary.begin();
@@ -126,18 +256,15 @@ void FundGroup<ComplexSupplierType>::CreateSpanningTree()
 template <typename ComplexSupplierType>
 void FundGroup<ComplexSupplierType>::ComputeRelators()
 {
-    typename std::map<Id, Chain>::iterator it = _2Boundaries.begin();
-    typename std::map<Id, Chain>::iterator itEnd = _2Boundaries.end();
-
-    for ( ; it != itEnd; ++it)
+    Cells &edges = _spanningTreeEdges;
+    _relators.Clear();
+    _relators.Reserve(_2Boundaries.WordsCount(), _2Boundaries.LettersCount());
+    for (size_t i = 0; i < _2Boundaries.WordsCount(); i++)
     {
-        Cells &edges = _spanningTreeEdges;
-        Relator r;
-        Chain boundary = it->second;
-        typename Chain::iterator jt = boundary.begin();
-        typename Chain::iterator jtEnd = boundary.end();
-
-        for ( ; jt != jtEnd; ++jt)
+        size_t length = 0;
+        LetterIterator it = _2Boundaries.WordBegin(i);
+        LetterIterator itEnd = _2Boundaries.WordEnd(i);
+        for ( ; it != itEnd; ++it)
         {
             // if edge is not contained in the spanning tree
             // add it as relator with proper sign
@@ -145,14 +272,15 @@ void FundGroup<ComplexSupplierType>::ComputeRelators()
             // if we assume that space may be disconnected then
             // we need to check if 2-boundary is in current connected component
             // (for example by checking if a vertex is contained in spanning tree)
-            if (edges.find(jt->first) == edges.end())
+            if (edges.find(Relators::GetId(*it)) == edges.end())
             {
-                r.push_back(RelatorComponent(jt->first, jt->second));
+                _relators.Append(*it);
+                length++;
             }
         }
-        if (r.size() > 0)
+        if (length > 0)
         {
-            _relators.push_back(r);
+            _relators.EndWord();
         }
     }
 }
@@ -161,7 +289,7 @@ template <typename ComplexSupplierType>
 void FundGroup<ComplexSupplierType>::SimplifyRelators()
 {
     std::set<Id>& generators = _cellsByDim[1];
-    size_t relatorsCount = _relators.size();
+    size_t relatorsCount = _relators.WordsCount();
     std::vector<bool> unusedRelators(relatorsCount);
     bool reduced = true;
     while (reduced)
@@ -173,25 +301,28 @@ void FundGroup<ComplexSupplierType>::SimplifyRelators()
             {
                 continue;
             }
-            Relator r = _relators[i];
             size_t reducedCount = 0;
-            typename Relator::iterator generatorToReduce;
-            for (typename Relator::iterator it = r.begin(); it != r.end(); ++it)
+            size_t length = _relators.WordLength(i);
+            Id generatorToReduce = Id();
+            LetterIterator it = _relators.WordBegin(i);
+            LetterIterator itEnd = _relators.WordEnd(i);
+            for ( ; it != itEnd; ++it)
             {
-                if (generators.find(it->first) == generators.end())
+                Id id = Relators::GetId(*it);
+                if (generators.find(id) == generators.end())
                 {
                     reducedCount++;
                 }
                 else
                 {
-                    generatorToReduce = it;
+                    generatorToReduce = id;
                 }
             }
-            if (reducedCount >= r.size() - 1)
+            if (reducedCount >= length - 1)
             {
-                if (reducedCount == r.size() - 1)
+                if (reducedCount == length - 1)
                 {
-                    generators.erase(generatorToReduce->first);
+                    generators.erase(generatorToReduce);
                 }
                 unusedRelators[i] = true;
                 reduced = true;
@@ -200,26 +331,244 @@ void FundGroup<ComplexSupplierType>::SimplifyRelators()
         _logger.Log(FGLogger::Debug)<<"generators left: "<<generators.size()<<std::endl;
     }
     Relators newRelators;
+    newRelators.Reserve(relatorsCount, _relators.LettersCount());
     for (size_t i = 0; i < relatorsCount; i++)
     {
         if (unusedRelators[i])
         {
             continue;
         }
-        Relator r;
-        for (typename Relator::iterator it = _relators[i].begin();
-                                        it != _relators[i].end();
-                                        ++it)
+        size_t length = 0;
+        LetterIterator it = _relators.WordBegin(i);
+        LetterIterator itEnd = _relators.WordEnd(i);
+        for ( ; it != itEnd; ++it)
+        {
+            if (generators.find(Relators::GetId(*it)) != generators.end())
+            {
+                newRelators.Append(*it);
+                length++;
+            }
+        }
+        assert(length > 1);
+        newRelators.EndWord();
+    }
+    _relators.Swap(newRelators);
+}
+
+template <typename ComplexSupplierType>
+size_t FundGroup<ComplexSupplierType>::EliminateGenerators()
+{
+    // a generator occurring exactly once in a relator r = g^e w is replaced
+    // by w^-e in all other relators and dropped together with r, this is
+    // what collapsing a 2-cell through its free 1-cell face does to the
+    // presentation; only eliminations not increasing the total length of
+    // relators are performed, so every pass shortens the presentation
+    typedef typename Relators::Word Word;
+    typedef std::map<Id, size_t> Occurrences;
+    std::set<Id>& generators = _cellsByDim[1];
+    std::vector<Word> words(_relators.WordsCount());
+    std::vector<bool> removed(words.size(), false);
+    Occurrences occurrences;
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        words[i].assign(_relators.WordBegin(i), _relators.WordEnd(i));
+        typename Word::iterator it = words[i].begin();
+        typename Word::iterator itEnd = words[i].end();
+        for ( ; it != itEnd; ++it)
         {
-            if (generators.find(it->first) != generators.end())
+            occurrences[Relators::GetId(*it)]++;
+        }
+    }
+
+    size_t eliminatedCount = 0;
+    bool eliminated = true;
+    while (eliminated)
+    {
+        eliminated = false;
+        for (size_t i = 0; i < words.size(); i++)
+        {
+            if (removed[i])
+            {
+                continue;
+            }
+            Word& word = words[i];
+            size_t length = word.size();
+            Occurrences wordOccurrences;
+            typename Word::iterator it = word.begin();
+            typename Word::iterator itEnd = word.end();
+            for ( ; it != itEnd; ++it)
+            {
+                wordOccurrences[Relators::GetId(*it)]++;
+            }
+            // position of the generator to eliminate
+            size_t position = length;
+            for (size_t j = 0; j < length && position == length; j++)
+            {
+                Id id = Relators::GetId(word[j]);
+                size_t others = occurrences[id] - 1;
+                if (wordOccurrences[id] == 1 && (length < 2 || others * (length - 2) <= length))
+                {
+                    position = j;
+                }
+            }
+            if (position == length)
+            {
+                continue;
+            }
+
+            // g^e w = 1, so g = w^-e and g^-1 = w^e
+            Letter letter = word[position];
+            Id generator = Relators::GetId(letter);
+            Word replacement;
+            replacement.reserve(length - 1);
+            for (size_t j = 1; j < length; j++)
+            {
+                replacement.push_back(word[(position + j) % length]);
+            }
+            Word inverse(replacement.rbegin(), replacement.rend());
+            for (size_t j = 0; j < inverse.size(); j++)
+            {
+                inverse[j] = -inverse[j];
+            }
+            const Word& positive = Relators::GetSign(letter) > 0 ? inverse : replacement;
+            const Word& negative = Relators::GetSign(letter) > 0 ? replacement : inverse;
+
+            for (it = word.begin(); it != itEnd; ++it)
             {
-                r.push_back(*it);
+                occurrences[Relators::GetId(*it)]--;
+            }
+            removed[i] = true;
+            generators.erase(generator);
+            eliminatedCount++;
+            eliminated = true;
+
+            for (size_t k = 0; k < words.size() && occurrences[generator] > 0; k++)
+            {
+                if (removed[k] || (std::find(words[k].begin(), words[k].end(), letter) == words[k].end()
+                                   && std::find(words[k].begin(), words[k].end(), -letter) == words[k].end()))
+                {
+                    continue;
+                }
+                Word substituted;
+                substituted.reserve(words[k].size() + length);
+                typename Word::iterator jt = words[k].begin();
+                typename Word::iterator jtEnd = words[k].end();
+                for ( ; jt != jtEnd; ++jt)
+                {
+                    occurrences[Relators::GetId(*jt)]--;
+                    if (Relators::GetId(*jt) != generator)
+                    {
+                        substituted.push_back(*jt);
+                        continue;
+                    }
+                    const Word& part = Relators::GetSign(*jt) > 0 ? positive : negative;
+                    substituted.insert(substituted.end(), part.begin(), part.end());
+                }
+                Relators::FreeReduce(substituted);
+                Relators::CyclicReduce(substituted);
+                for (jt = substituted.begin(); jt != substituted.end(); ++jt)
+                {
+                    occurrences[Relators::GetId(*jt)]++;
+                }
+                words[k].swap(substituted);
+                removed[k] = words[k].empty();
             }
         }
-        assert(r.size() > 1);
-        newRelators.push_back(r);
     }
-    _relators.assign(newRelators.begin(), newRelators.end());
+
+    Relators newRelators;
+    newRelators.Reserve(words.size(), _relators.LettersCount());
+    for (size_t i = 0; i < words.size(); i++)
+    {
+        if (!removed[i])
+        {
+            newRelators.Append(&words[i][0], &words[i][0] + words[i].size());
+            newRelators.EndWord();
+        }
+    }
+    _relators.Swap(newRelators);
+    _logger.Log(FGLogger::Details)<<"generators eliminated: "<<eliminatedCount;
+    _logger.Log(FGLogger::Details)<<", "<<generators.size()<<" left"<<std::endl;
+    return eliminatedCount;
+}
+
+template <typename ComplexSupplierType>
+void FundGroup<ComplexSupplierType>::CanonicalizeRelators()
+{
+    // every relator is freely and cyclically reduced and brought to
+    // a canonical rotation, so that trivial relators as well as
+    // duplicates (up to rotation and inversion) can be dropped
+    typedef boost::unordered_multimap<size_t, size_t> RelatorsHashes;
+    typedef typename RelatorsHashes::iterator RelatorsHashesIterator;
+    typename Relators::Word word;
+    RelatorsHashes hashes;
+    Relators newRelators;
+    newRelators.Reserve(_relators.WordsCount(), _relators.LettersCount());
+    for (size_t i = 0; i < _relators.WordsCount(); i++)
+    {
+        word.assign(_relators.WordBegin(i), _relators.WordEnd(i));
+        Relators::FreeReduce(word);
+        Relators::CyclicReduce(word);
+        if (word.empty())
+        {
+            continue;
+        }
+        Relators::Canonicalize(word);
+
+        size_t hash = boost::hash_range(word.begin(), word.end());
+        std::pair<RelatorsHashesIterator, RelatorsHashesIterator> range = hashes.equal_range(hash);
+        bool found = false;
+        for (RelatorsHashesIterator it = range.first; !found && it != range.second; ++it)
+        {
+            found = newRelators.WordLength(it->second) == word.size()
+                    && std::equal(word.begin(), word.end(), newRelators.WordBegin(it->second));
+        }
+        if (!found)
+        {
+            hashes.insert(std::make_pair(hash, newRelators.WordsCount()));
+            newRelators.Append(&word[0], &word[0] + word.size());
+            newRelators.EndWord();
+        }
+    }
+    _logger.Log(FGLogger::Details)<<"relators after canonicalization: "<<newRelators.WordsCount();
+    _logger.Log(FGLogger::Details)<<" of "<<_relators.WordsCount()<<std::endl;
+    _relators.Swap(newRelators);
+}
+
+template <typename ComplexSupplierType>
+void FundGroup<ComplexSupplierType>::ComputeAbelianInvariants()
+{
+    // relation matrix of the abelianized group:
+    // one row per relator, one column per generator
+    std::map<Id, int> columns;
+    Cells &_1cells = _cellsByDim[1];
+    for (typename Cells::iterator it = _1cells.begin(); it != _1cells.end(); ++it)
+    {
+        int column = static_cast<int>(columns.size());
+        columns[*it] = column;
+    }
+
+    SmithNormalForm<long long> snf(static_cast<int>(columns.size()));
+    typename SmithNormalForm<long long>::Row row;
+    for (size_t i = 0; i < _relators.WordsCount(); i++)
+    {
+        row.clear();
+        LetterIterator it = _relators.WordBegin(i);
+        LetterIterator itEnd = _relators.WordEnd(i);
+        for ( ; it != itEnd; ++it)
+        {
+            row.push_back(std::make_pair(columns[Relators::GetId(*it)],
+                                         static_cast<long long>(Relators::GetSign(*it))));
+        }
+        snf.AddRow(row);
+    }
+    snf.ComputeAbelianInvariants(_abelianInvariants);
+}
+
+template <typename ComplexSupplierType>
+const std::vector<long long>& FundGroup<ComplexSupplierType>::GetAbelianInvariants() const
+{
+    return _abelianInvariants;
 }
 
 template <typename ComplexSupplierType>
@@ -254,14 +603,13 @@ std::string FundGroup<ComplexSupplierType>::ToString()
 
     {
         str<<"Relators:"<<std::endl;
-        typename Relators::iterator it = _relators.begin();
-        typename Relators::iterator itEnd = _relators.end();
-        for ( ; it != itEnd; ++it)
+        Syllables r;
+        for (size_t i = 0; i < _relators.WordsCount(); i++)
         {
-            Relator r = *it;
+            _relators.GetSyllables(i, r);
             int index = 0;
-            typename Relator::iterator jt = r.begin();
-            typename Relator::iterator jtEnd = r.end();
+            typename Syllables::iterator jt = r.begin();
+            typename Syllables::iterator jtEnd = r.end();
             for ( ; jt != jtEnd; ++jt)
             {
                 str<<"f"<<symbols[jt->first];
@@ -278,6 +626,20 @@ std::string FundGroup<ComplexSupplierType>::ToString()
         }
     }
 
+    if (_options._abelianInvariants)
+    {
+        str<<"Abelian invariants: [ ";
+        for (size_t i = 0; i < _abelianInvariants.size(); i++)
+        {
+            str<<_abelianInvariants[i];
+            if (i + 1 < _abelianInvariants.size())
+            {
+                str<<", ";
+            }
+        }
+        str<<" ]"<<std::endl;
+    }
+
     return str.str();
 }
 
@@ -315,15 +677,14 @@ std::string FundGroup<ComplexSupplierType>::HapExpression() const
         output<<"g:=GeneratorsOfGroup(F);"<<std::endl;
         output<<"rels:=[];"<<std::endl;
 
-        typename Relators::const_iterator it = _relators.begin();
-        typename Relators::const_iterator itEnd = _relators.end();
-        for ( ; it != itEnd; ++it)
+        Syllables r;
+        for (size_t i = 0; i < _relators.WordsCount(); i++)
         {
-            Relator r = *it;
+            _relators.GetSyllables(i, r);
             int index = 0;
 
-            typename Relator::iterator jt = r.begin();
-            typename Relator::iterator jtEnd = r.end();
+            typename Syllables::iterator jt = r.begin();
+            typename Syllables::iterator jtEnd = r.end();
             output<<"w:=";
             for ( ; jt != jtEnd; ++jt)
             {
@@ -381,15 +742,14 @@ std::vector<int> FundGroup<ComplexSupplierType>::HapInterfaceVector() const
     }
 
     {
-        ret.push_back(_relators.size());
-        typename Relators::const_iterator it = _relators.begin();
-        typename Relators::const_iterator itEnd = _relators.end();
-        for ( ; it != itEnd; ++it)
+        ret.push_back(_relators.WordsCount());
+        Syllables r;
+        for (size_t i = 0; i < _relators.WordsCount(); i++)
         {
-            Relator r = *it;
+            _relators.GetSyllables(i, r);
             ret.push_back(r.size());
-            typename Relator::iterator jt = r.begin();
-            typename Relator::iterator jtEnd = r.end();
+            typename Syllables::iterator jt = r.begin();
+            typename Syllables::iterator jtEnd = r.end();
             for ( ; jt != jtEnd; ++jt)
             {
                 ret.push_back(symbols[jt->first]);
@@ -404,7 +764,10 @@ std::vector<int> FundGroup<ComplexSupplierType>::HapInterfaceVector() const
 template <typename ComplexSupplierType>
 void FundGroup<ComplexSupplierType>::PrintDebug()
 {
-    _complexSupplier->PrintDebug();
+    if (_complexSupplier)
+    {
+        _complexSupplier->PrintDebug();
+    }
 
     _logger.Log(FGLogger::Debug)<<"cells:"<<std::endl;
     for (int i = 0; i < _cellsByDim.size(); i++)
@@ -417,14 +780,18 @@ void FundGroup<ComplexSupplierType>::PrintDebug()
     }
 
     _logger.Log(FGLogger::Debug)<<"homotopic 2 boundaries:"<<std::endl;
-    for (typename std::map<Id, Chain>::iterator it = _2Boundaries.begin();
-                                                  it != _2Boundaries.end();
-                                                  ++it)
+    if (_cellsByDim.size() > 2)
     {
-        _logger.Log(FGLogger::Debug)<<"cell: "<<it->first<<std::endl;
-        for (typename Chain::iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+        size_t i = 0;
+        for (typename Cells::iterator it = _cellsByDim[2].begin();
+                                      it != _cellsByDim[2].end() && i < _2Boundaries.WordsCount();
+                                      ++it, ++i)
         {
-            _logger.Log(FGLogger::Debug)<<jt->first<<" "<<jt->second<<std::endl;
+            _logger.Log(FGLogger::Debug)<<"cell: "<<*it<<std::endl;
+            for (LetterIterator jt = _2Boundaries.WordBegin(i); jt != _2Boundaries.WordEnd(i); ++jt)
+            {
+                _logger.Log(FGLogger::Debug)<<Chains::GetId(*jt)<<" "<<Chains::GetSign(*jt)<<std::endl;
+            }
         }
     }
 }
@@ -0,0 +1,79 @@
+/*
+ * File:   GrayscaleVolume.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef GRAYSCALEVOLUME_H
+#define	GRAYSCALEVOLUME_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+// 2D or 3D grayscale image, cubical sets are its sublevel sets (voxels
+// of value not greater than a threshold). Supported formats:
+// *.pgm - P2 (ASCII) or P5 (binary) PGM image, consecutive images of
+//         the same size are slices of a 3D volume
+// *.raw - voxels without header, sizes are given in the file name as
+//         "name_WxH.raw" or "name_WxHxD.raw", voxels have one byte or
+//         two bytes (little endian) depending on the file size
+// Voxels are stored with the first coordinate changing fastest.
+template <typename ValueT>
+class GrayscaleVolume
+{
+public:
+
+    typedef ValueT                  Value;
+    typedef std::vector<Value>      Values;
+    // one byte per voxel, 1 if the voxel belongs to the set
+    typedef std::vector<unsigned char> Mask;
+    // indices of voxels
+    typedef std::vector<size_t>     Voxels;
+
+    enum
+    {
+        MAX_DIM = 3,
+    };
+
+    GrayscaleVolume();
+
+    static bool IsVolumeFile(const char* filename);
+
+    void Load(const char* filename);
+
+    size_t GetSize(int dim) const;
+    size_t GetVoxelsCount() const;
+    Value GetValue(size_t voxel) const;
+
+    // voxels with value <= threshold
+    void GetSublevelMask(Value threshold, Mask& mask) const;
+    // orders the voxels by value (once, needed by GetLevelVoxels)
+    void SortByValue();
+    // range of the sorted voxels with lower < value <= upper, i.e. voxels
+    // added when the threshold is raised from lower to upper
+    void GetLevelVoxels(Value lower, Value upper,
+                        Voxels::const_iterator& begin, Voxels::const_iterator& end) const;
+
+private:
+
+    void LoadPgm(const char* filename);
+    void LoadRaw(const char* filename);
+    // returns false if there is no next image in the stream
+    bool ParsePgmImage(std::istream& input);
+    static bool ParsePgmNumber(std::istream& input, size_t& number);
+    static bool ParseRawSizes(const std::string& filename, size_t* sizes);
+    // number of the sorted voxels with value <= threshold
+    size_t GetSublevelCount(Value threshold) const;
+
+    size_t  _sizes[MAX_DIM];
+    Values  _values;
+    // voxels sorted by value and positions of the first voxel of every
+    // value in it (up to the maximal value of the volume and one more)
+    Voxels  _sortedVoxels;
+    Voxels  _valueOffsets;
+};
+
+#include "GrayscaleVolume.hpp"
+
+#endif	/* GRAYSCALEVOLUME_H */
@@ -0,0 +1,322 @@
+/*
+ * File:   GrayscaleVolume.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef GRAYSCALEVOLUME_HPP
+#define	GRAYSCALEVOLUME_HPP
+
+#include "GrayscaleVolume.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "FGLogger.h"
+
+template <typename ValueT>
+GrayscaleVolume<ValueT>::GrayscaleVolume()
+{
+    for (int dim = 0; dim < MAX_DIM; dim++)
+    {
+        _sizes[dim] = 0;
+    }
+}
+
+template <typename ValueT>
+bool GrayscaleVolume<ValueT>::IsVolumeFile(const char* filename)
+{
+    // determining file type by its extension, as in CubesSupplier
+    size_t len = strlen(filename);
+    if (len < 5 || filename[len - 4] != '.')
+    {
+        return false;
+    }
+    std::string extension;
+    for (size_t i = len - 3; i < len; i++)
+    {
+        extension += static_cast<char>(tolower(filename[i]));
+    }
+    return extension == "pgm" || extension == "raw";
+}
+
+template <typename ValueT>
+void GrayscaleVolume<ValueT>::Load(const char* filename)
+{
+    FGLogger logger;
+    logger.Begin(FGLogger::Details, "parsing grayscale volume");
+    for (int dim = 0; dim < MAX_DIM; dim++)
+    {
+        _sizes[dim] = 0;
+    }
+    _values.clear();
+    _sortedVoxels.clear();
+    _valueOffsets.clear();
+    size_t len = strlen(filename);
+    if (tolower(filename[len - 3]) == 'p')
+    {
+        LoadPgm(filename);
+    }
+    else
+    {
+        LoadRaw(filename);
+    }
+    logger.End();
+    logger.Log(FGLogger::Details)<<"parsed "<<_sizes[0]<<"x"<<_sizes[1]<<"x"<<_sizes[2]<<" voxels"<<std::endl;
+}
+
+template <typename ValueT>
+size_t GrayscaleVolume<ValueT>::GetSize(int dim) const
+{
+    return dim < MAX_DIM ? _sizes[dim] : 1;
+}
+
+template <typename ValueT>
+size_t GrayscaleVolume<ValueT>::GetVoxelsCount() const
+{
+    return _values.size();
+}
+
+template <typename ValueT>
+typename GrayscaleVolume<ValueT>::Value
+GrayscaleVolume<ValueT>::GetValue(size_t voxel) const
+{
+    return _values[voxel];
+}
+
+template <typename ValueT>
+void GrayscaleVolume<ValueT>::GetSublevelMask(Value threshold, Mask& mask) const
+{
+    size_t count = _values.size();
+    mask.resize(count);
+    if (count == 0)
+    {
+        return;
+    }
+    const Value* values = &_values[0];
+    unsigned char* bits = &mask[0];
+    // no branches, so that the comparison is vectorized by the compiler
+    for (size_t i = 0; i < count; i++)
+    {
+        bits[i] = static_cast<unsigned char>(values[i] <= threshold);
+    }
+}
+
+template <typename ValueT>
+void GrayscaleVolume<ValueT>::SortByValue()
+{
+    // counting sort, values are small integers
+    size_t count = _values.size();
+    size_t maxValue = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        maxValue = std::max(maxValue, static_cast<size_t>(_values[i]));
+    }
+    _valueOffsets.assign(maxValue + 2, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        _valueOffsets[static_cast<size_t>(_values[i]) + 1]++;
+    }
+    for (size_t value = 1; value < _valueOffsets.size(); value++)
+    {
+        _valueOffsets[value] += _valueOffsets[value - 1];
+    }
+    _sortedVoxels.resize(count);
+    Voxels positions(_valueOffsets.begin(), _valueOffsets.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        _sortedVoxels[positions[static_cast<size_t>(_values[i])]++] = i;
+    }
+}
+
+template <typename ValueT>
+void GrayscaleVolume<ValueT>::GetLevelVoxels(Value lower, Value upper,
+                                             Voxels::const_iterator& begin, Voxels::const_iterator& end) const
+{
+    if (_valueOffsets.empty())
+    {
+        throw std::logic_error("voxels are not sorted by value");
+    }
+    begin = _sortedVoxels.begin() + GetSublevelCount(lower);
+    end = _sortedVoxels.begin() + std::max(GetSublevelCount(lower), GetSublevelCount(upper));
+}
+
+template <typename ValueT>
+size_t GrayscaleVolume<ValueT>::GetSublevelCount(Value threshold) const
+{
+    // values above the maximal one have no voxels
+    size_t value = std::min(static_cast<size_t>(threshold) + 1, _valueOffsets.size() - 1);
+    return _valueOffsets[value];
+}
+
+template <typename ValueT>
+void GrayscaleVolume<ValueT>::LoadPgm(const char* filename)
+{
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.is_open())
+    {
+        throw std::runtime_error(std::string("cannot open file ") + filename);
+    }
+    while (ParsePgmImage(input))
+    {
+        _sizes[2]++;
+    }
+    if (_sizes[2] == 0)
+    {
+        throw std::runtime_error(std::string("no PGM image in file ") + filename);
+    }
+}
+
+template <typename ValueT>
+void GrayscaleVolume<ValueT>::LoadRaw(const char* filename)
+{
+    if (!ParseRawSizes(filename, _sizes))
+    {
+        throw std::runtime_error(std::string("no _WxH or _WxHxD sizes in file name ") + filename);
+    }
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.is_open())
+    {
+        throw std::runtime_error(std::string("cannot open file ") + filename);
+    }
+    input.seekg(0, std::ios::end);
+    size_t fileSize = static_cast<size_t>(input.tellg());
+    input.seekg(0, std::ios::beg);
+
+    size_t count = _sizes[0] * _sizes[1] * _sizes[2];
+    size_t bytes = fileSize == count ? 1 : 2;
+    if (fileSize != count * bytes || (bytes == 2 && std::numeric_limits<Value>::max() < 65535))
+    {
+        throw std::runtime_error(std::string("size of file does not match its name ") + filename);
+    }
+    std::vector<unsigned char> buffer(fileSize);
+    if (fileSize > 0 && !input.read(reinterpret_cast<char*>(&buffer[0]), fileSize))
+    {
+        throw std::runtime_error(std::string("cannot read file ") + filename);
+    }
+    _values.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        _values[i] = bytes == 1 ? buffer[i] : static_cast<Value>(buffer[2 * i] | (buffer[2 * i + 1] << 8));
+    }
+}
+
+template <typename ValueT>
+bool GrayscaleVolume<ValueT>::ParsePgmImage(std::istream& input)
+{
+    char magic[2];
+    input>>std::ws;
+    if (!input.get(magic[0]))
+    {
+        return false;
+    }
+    if (!input.get(magic[1]) || magic[0] != 'P' || (magic[1] != '2' && magic[1] != '5'))
+    {
+        throw std::runtime_error("only P2 and P5 PGM images are supported");
+    }
+    size_t width;
+    size_t height;
+    size_t maxValue;
+    if (!ParsePgmNumber(input, width) || !ParsePgmNumber(input, height) || !ParsePgmNumber(input, maxValue))
+    {
+        throw std::runtime_error("corrupted PGM header");
+    }
+    if (maxValue == 0 || maxValue > 65535 || maxValue > std::numeric_limits<Value>::max())
+    {
+        throw std::runtime_error("unsupported PGM maximal value");
+    }
+    if (_sizes[2] == 0)
+    {
+        _sizes[0] = width;
+        _sizes[1] = height;
+    }
+    else if (_sizes[0] != width || _sizes[1] != height)
+    {
+        throw std::runtime_error("slices of PGM volume differ in size");
+    }
+
+    size_t count = width * height;
+    size_t offset = _values.size();
+    _values.resize(offset + count);
+    if (magic[1] == '2')
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t value;
+            if (!ParsePgmNumber(input, value) || value > maxValue)
+            {
+                throw std::runtime_error("corrupted PGM image");
+            }
+            _values[offset + i] = static_cast<Value>(value);
+        }
+        return true;
+    }
+
+    // single whitespace separates the header from the binary data,
+    // values greater than 255 take two bytes (most significant first)
+    input.get();
+    size_t bytes = maxValue < 256 ? 1 : 2;
+    std::vector<unsigned char> buffer(count * bytes);
+    if (count > 0 && !input.read(reinterpret_cast<char*>(&buffer[0]), buffer.size()))
+    {
+        throw std::runtime_error("truncated PGM image");
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        _values[offset + i] = bytes == 1 ? buffer[i] : static_cast<Value>((buffer[2 * i] << 8) | buffer[2 * i + 1]);
+    }
+    return true;
+}
+
+template <typename ValueT>
+bool GrayscaleVolume<ValueT>::ParsePgmNumber(std::istream& input, size_t& number)
+{
+    // comments last till the end of line
+    input>>std::ws;
+    while (input.peek() == '#')
+    {
+        std::string comment;
+        std::getline(input, comment);
+        input>>std::ws;
+    }
+    return !(input>>number).fail();
+}
+
+template <typename ValueT>
+bool GrayscaleVolume<ValueT>::ParseRawSizes(const std::string& filename, size_t* sizes)
+{
+    // "path/name_WxHxD.raw" -> "WxHxD"
+    size_t begin = filename.rfind('_');
+    size_t end = filename.rfind('.');
+    if (begin == std::string::npos || end == std::string::npos || begin > end
+        || filename.find('/', begin) != std::string::npos)
+    {
+        return false;
+    }
+    std::string text = filename.substr(begin + 1, end - begin - 1);
+    sizes[2] = 1;
+    size_t position = 0;
+    for (int dim = 0; dim < MAX_DIM; dim++)
+    {
+        size_t next = text.find('x', position);
+        std::string size = text.substr(position, next == std::string::npos ? std::string::npos : next - position);
+        if (size.empty() || size.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        sizes[dim] = static_cast<size_t>(strtoul(size.c_str(), 0, 10));
+        if (next == std::string::npos)
+        {
+            return dim >= 1;
+        }
+        position = next + 1;
+    }
+    // more than MAX_DIM sizes
+    return false;
+}
+
+#endif	/* GRAYSCALEVOLUME_HPP */
@@ -6,10 +6,11 @@
 #ifndef HOMOLOGYHELPERS_H
 #define	HOMOLOGYHELPERS_H
 
-#include <list>
 #include <vector>
 #include <capd/complex/CubCellComplex.h>
 
+#include "InlineVector.h"
+
 template <typename Traits>
 class HomologyHelpers
 {
@@ -20,20 +21,20 @@ public:
 
     template <typename SComplexType>
     static void Reorder2Boundary(SComplexType*,
-                    std::list<std::pair<typename SComplexType::Id, int> > &boundary);
+                    InlineVector<std::pair<typename SComplexType::Id, int>, 4>& boundary);
 
     template <typename ComplexTraits>
     static void Reorder2Boundary(SComplex<ComplexTraits>*,
-                    std::list<std::pair<typename SComplex<ComplexTraits>::Id, int> > &boundary);
+                    InlineVector<std::pair<typename SComplex<ComplexTraits>::Id, int>, 4>& boundary);
 
     template <int DIM>
     static void Reorder2Boundary(CubSComplex<DIM>*,
-                    std::list<std::pair<typename CubSComplex<DIM>::Id, int> > &boundary);
+                    InlineVector<std::pair<typename CubSComplex<DIM>::Id, int>, 4>& boundary);
 
 
   template <typename T>
   static void Reorder2Boundary(CubCellComplex<T>* complex,
-                               std::list<std::pair<typename CubCellComplex<T>::Id, int> >& boundary);
+                               InlineVector<std::pair<typename CubCellComplex<T>::Id, int>, 4>& boundary);
 
 };
 
@@ -8,6 +8,8 @@
 
 #include "HomologyHelpers.h"
 
+#include <algorithm>
+
 #include <capd/complex/BettiNumbers.hpp>
 
 template <typename Traits>
@@ -34,7 +36,7 @@ std::vector<int> HomologyHelpers<Traits>::GetHomologySignature(SComplexType* com
 template <typename Traits>
 template <typename SComplexType>
 void HomologyHelpers<Traits>::Reorder2Boundary(SComplexType*,
-         std::list<std::pair<typename SComplexType::Id, int> >& boundary)
+         InlineVector<std::pair<typename SComplexType::Id, int>, 4>& boundary)
 {
     // in general case does nothing
 }
@@ -49,7 +51,6 @@ void Get1Boundary(ComplexType* complex, typename ComplexType::Id cellId, typenam
     typedef typename ComplexType::Cell Cell;
     typedef typename ComplexType::Iterators::BdCells BdCells;
     Cell cell = (*complex)[cellId];
-    std::list<std::pair<Id, int> > boundary;
     BdCells bdCells = complex->iterators().bdCells(cell);
     typename BdCells::iterator it = bdCells.begin();
     typename BdCells::iterator itEnd = bdCells.end();
@@ -70,12 +71,12 @@ void Get1Boundary(ComplexType* complex, typename ComplexType::Id cellId, typenam
     }
 }
 
-template <typename ComplexType>
-void Print2Boundary(ComplexType* complex, std::list<std::pair<typename ComplexType::Id, int> >& boundary)
+template <typename ComplexType, typename Boundary>
+void Print2Boundary(ComplexType* complex, Boundary& boundary)
 {
     typedef typename ComplexType::Id Id;
-    typename std::list<std::pair<Id, int> >::iterator it = boundary.begin();
-    typename std::list<std::pair<Id, int> >::iterator itEnd = boundary.end();
+    typename Boundary::iterator it = boundary.begin();
+    typename Boundary::iterator itEnd = boundary.end();
     for( ; it != itEnd; ++it)
     {
         Id v0, v1;
@@ -89,68 +90,33 @@ void Print2Boundary(ComplexType* complex, std::list<std::pair<typename ComplexTy
 template <typename Traits>
 template <typename ComplexTraits>
 void HomologyHelpers<Traits>::Reorder2Boundary(SComplex<ComplexTraits>*,
-         std::list<std::pair<typename SComplex<ComplexTraits>::Id, int> >& boundary)
+         InlineVector<std::pair<typename SComplex<ComplexTraits>::Id, int>, 4>& boundary)
 {
-    typedef typename SComplex<ComplexTraits>::Id Id;
-    typedef std::pair<Id, int> Cell;
-    typedef std::list<Cell> CellsList;
-
     // reordering (1, 2, 4, 3) -> (1, 2, 3, 4)
     assert(boundary.size() == 4);
-    typename CellsList::iterator it = boundary.begin();
-    // skip first two
-    it++;
-    it++;
-    // remember and remove 3rd element
-    Cell cell = *it;
-    it = boundary.erase(it);
-    // insert remembered cell at the end
-    it++;
-    boundary.insert(it, cell);
+    std::swap(boundary[2], boundary[3]);
 }
 
 template <typename Traits>
 template <int DIM>
 void HomologyHelpers<Traits>::Reorder2Boundary(CubSComplex<DIM>* complex,
-        std::list<std::pair<typename CubSComplex<DIM>::Id, int> >& boundary)
+        InlineVector<std::pair<typename CubSComplex<DIM>::Id, int>, 4>& boundary)
 {
-    typedef typename CubSComplex<DIM>::Id Id;
-    typedef std::pair<Id, int> Cell;
-    typedef std::list<Cell> CellsList;
-
-    // reordering (1, 3, 4, 2) -> (1, 2, 3, 4)
+    // reordering (1, 3, 4, 2) -> (1, 2, 3, 4),
+    // last cell goes to the second position
     assert(boundary.size() == 4);
-    // remember last cell and remove ir
-    typename CellsList::iterator it = boundary.end();
-    it--;
-    Cell cell = *it;
-    boundary.erase(it);
-    // skip first cell and insert remembered cell at second position
-    it = boundary.begin();
-    it++;
-    boundary.insert(it, cell);
+    std::rotate(boundary.begin() + 1, boundary.begin() + 3, boundary.end());
 }
 
 template <typename Traits>
 template <typename T>
 void HomologyHelpers<Traits>::Reorder2Boundary(CubCellComplex<T>* complex,
-        std::list<std::pair<typename CubCellComplex<T>::Id, int> >& boundary)
+        InlineVector<std::pair<typename CubCellComplex<T>::Id, int>, 4>& boundary)
 {
-    typedef typename CubCellComplex<T>::Id Id;
-    typedef std::pair<Id, int> Cell;
-    typedef std::list<Cell> CellsList;
-
-    // reordering (1, 3, 4, 2) -> (1, 2, 3, 4)
+    // reordering (1, 3, 4, 2) -> (1, 2, 3, 4),
+    // last cell goes to the second position
     assert(boundary.size() == 4);
-    // remember last cell and remove ir
-    typename CellsList::iterator it = boundary.end();
-    it--;
-    Cell cell = *it;
-    boundary.erase(it);
-    // skip first cell and insert remembered cell at second position
-    it = boundary.begin();
-    it++;
-    boundary.insert(it, cell);
+    std::rotate(boundary.begin() + 1, boundary.begin() + 3, boundary.end());
 }
 
 #endif	/* HOMOLOGYHELPERS_HPP */
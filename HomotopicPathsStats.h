@@ -0,0 +1,126 @@
+/*
+ * File:   HomotopicPathsStats.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef HOMOTOPICPATHSSTATS_H
+#define	HOMOTOPICPATHSSTATS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Counters collected while computing homotopic paths of AKQ reduction,
+// every thread collects its own and they are merged at the end.
+struct HomotopicPathsStats
+{
+    size_t  _queensResolved;
+    // queens found resolved (or not) when boundaries of 2-cells were joined
+    size_t  _memoHits;
+    size_t  _memoMisses;
+    // lengths of (reduced) queen paths
+    size_t  _totalPathLength;
+    size_t  _maxPathLength;
+    // i-th entry counts paths of length in [2^i - 1, 2^(i+1) - 1)
+    std::vector<size_t> _pathLengthHistogram;
+    size_t  _boundariesCount;
+    size_t  _totalBoundaryLength;
+    size_t  _maxBoundaryLength;
+    // pairs of letters cancelled when paths were joined
+    size_t  _joinReductions;
+    // memory kept by the queen paths memo
+    size_t  _bytesHeld;
+
+    HomotopicPathsStats()
+        : _queensResolved(0)
+        , _memoHits(0)
+        , _memoMisses(0)
+        , _totalPathLength(0)
+        , _maxPathLength(0)
+        , _boundariesCount(0)
+        , _totalBoundaryLength(0)
+        , _maxBoundaryLength(0)
+        , _joinReductions(0)
+        , _bytesHeld(0)
+    {}
+
+    void AddPathLength(size_t length)
+    {
+        _totalPathLength += length;
+        _maxPathLength = std::max(_maxPathLength, length);
+        size_t bucket = 0;
+        for (size_t l = length + 1; l > 1; l >>= 1)
+        {
+            bucket++;
+        }
+        if (_pathLengthHistogram.size() <= bucket)
+        {
+            _pathLengthHistogram.resize(bucket + 1, 0);
+        }
+        _pathLengthHistogram[bucket]++;
+    }
+
+    void AddBoundaryLength(size_t length)
+    {
+        _boundariesCount++;
+        _totalBoundaryLength += length;
+        _maxBoundaryLength = std::max(_maxBoundaryLength, length);
+    }
+
+    void Merge(const HomotopicPathsStats& other)
+    {
+        _queensResolved += other._queensResolved;
+        _memoHits += other._memoHits;
+        _memoMisses += other._memoMisses;
+        _totalPathLength += other._totalPathLength;
+        _maxPathLength = std::max(_maxPathLength, other._maxPathLength);
+        if (_pathLengthHistogram.size() < other._pathLengthHistogram.size())
+        {
+            _pathLengthHistogram.resize(other._pathLengthHistogram.size(), 0);
+        }
+        for (size_t i = 0; i < other._pathLengthHistogram.size(); i++)
+        {
+            _pathLengthHistogram[i] += other._pathLengthHistogram[i];
+        }
+        _boundariesCount += other._boundariesCount;
+        _totalBoundaryLength += other._totalBoundaryLength;
+        _maxBoundaryLength = std::max(_maxBoundaryLength, other._maxBoundaryLength);
+        _joinReductions += other._joinReductions;
+        _bytesHeld += other._bytesHeld;
+    }
+
+    // one "name value" pair per line
+    void Print(std::ostream& str) const
+    {
+        str<<"queens_resolved "<<_queensResolved<<std::endl;
+        str<<"memo_hits "<<_memoHits<<std::endl;
+        str<<"memo_misses "<<_memoMisses<<std::endl;
+        str<<"total_path_length "<<_totalPathLength<<std::endl;
+        str<<"max_path_length "<<_maxPathLength<<std::endl;
+        for (size_t i = 0; i < _pathLengthHistogram.size(); i++)
+        {
+            str<<"path_length_log2_"<<i<<" "<<_pathLengthHistogram[i]<<std::endl;
+        }
+        str<<"boundaries_count "<<_boundariesCount<<std::endl;
+        str<<"total_boundary_length "<<_totalBoundaryLength<<std::endl;
+        str<<"max_boundary_length "<<_maxBoundaryLength<<std::endl;
+        str<<"join_reductions "<<_joinReductions<<std::endl;
+        str<<"bytes_held "<<_bytesHeld<<std::endl;
+    }
+
+    bool Dump(const std::string& filename) const
+    {
+        std::ofstream output(filename.c_str());
+        if (!output.is_open())
+        {
+            return false;
+        }
+        Print(output);
+        return true;
+    }
+};
+
+#endif	/* HOMOTOPICPATHSSTATS_H */
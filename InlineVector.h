@@ -0,0 +1,53 @@
+/*
+ * File:   InlineVector.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef INLINEVECTOR_H
+#define	INLINEVECTOR_H
+
+#include <cstddef>
+#include <vector>
+
+// Vector keeping up to N elements inside the object (no allocation),
+// longer contents are moved to the heap. Used for boundaries of 2-cells
+// which in simplicial and cubical complexes have at most 4 faces.
+template <typename T, size_t N>
+class InlineVector
+{
+public:
+
+    typedef T               value_type;
+    typedef T*              iterator;
+    typedef const T*        const_iterator;
+
+    InlineVector();
+    InlineVector(const InlineVector& other);
+    InlineVector& operator=(const InlineVector& other);
+
+    void push_back(const T& value);
+    void clear();
+
+    size_t size() const;
+    bool empty() const;
+
+    T& operator[](size_t index);
+    const T& operator[](size_t index) const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+private:
+
+    bool IsInline() const;
+
+    T               _inline[N];
+    std::vector<T>  _heap;
+    size_t          _size;
+};
+
+#include "InlineVector.hpp"
+
+#endif	/* INLINEVECTOR_H */
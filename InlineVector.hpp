@@ -0,0 +1,128 @@
+/*
+ * File:   InlineVector.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef INLINEVECTOR_HPP
+#define	INLINEVECTOR_HPP
+
+#include "InlineVector.h"
+
+#include <algorithm>
+#include <cassert>
+
+template <typename T, size_t N>
+InlineVector<T, N>::InlineVector()
+    : _size(0)
+{
+}
+
+template <typename T, size_t N>
+InlineVector<T, N>::InlineVector(const InlineVector& other)
+    : _heap(other._heap)
+    , _size(other._size)
+{
+    if (other.IsInline())
+    {
+        std::copy(other._inline, other._inline + other._size, _inline);
+    }
+}
+
+template <typename T, size_t N>
+InlineVector<T, N>& InlineVector<T, N>::operator=(const InlineVector& other)
+{
+    if (this != &other)
+    {
+        _heap = other._heap;
+        _size = other._size;
+        if (other.IsInline())
+        {
+            std::copy(other._inline, other._inline + other._size, _inline);
+        }
+    }
+    return *this;
+}
+
+template <typename T, size_t N>
+void InlineVector<T, N>::push_back(const T& value)
+{
+    if (IsInline() && _size < N)
+    {
+        _inline[_size++] = value;
+        return;
+    }
+    if (IsInline())
+    {
+        // moving to the heap
+        _heap.reserve(2 * N);
+        _heap.assign(_inline, _inline + _size);
+    }
+    _heap.push_back(value);
+    _size++;
+}
+
+template <typename T, size_t N>
+void InlineVector<T, N>::clear()
+{
+    _heap.clear();
+    _size = 0;
+}
+
+template <typename T, size_t N>
+size_t InlineVector<T, N>::size() const
+{
+    return _size;
+}
+
+template <typename T, size_t N>
+bool InlineVector<T, N>::empty() const
+{
+    return _size == 0;
+}
+
+template <typename T, size_t N>
+T& InlineVector<T, N>::operator[](size_t index)
+{
+    assert(index < _size);
+    return begin()[index];
+}
+
+template <typename T, size_t N>
+const T& InlineVector<T, N>::operator[](size_t index) const
+{
+    assert(index < _size);
+    return begin()[index];
+}
+
+template <typename T, size_t N>
+typename InlineVector<T, N>::iterator InlineVector<T, N>::begin()
+{
+    return IsInline() ? _inline : &_heap[0];
+}
+
+template <typename T, size_t N>
+typename InlineVector<T, N>::iterator InlineVector<T, N>::end()
+{
+    return begin() + _size;
+}
+
+template <typename T, size_t N>
+typename InlineVector<T, N>::const_iterator InlineVector<T, N>::begin() const
+{
+    return IsInline() ? _inline : &_heap[0];
+}
+
+template <typename T, size_t N>
+typename InlineVector<T, N>::const_iterator InlineVector<T, N>::end() const
+{
+    return begin() + _size;
+}
+
+template <typename T, size_t N>
+bool InlineVector<T, N>::IsInline() const
+{
+    // heap is used only for more than N elements
+    return _heap.empty();
+}
+
+#endif	/* INLINEVECTOR_HPP */
@@ -0,0 +1,78 @@
+/*
+ * File:   KappaMapBuffer.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef KAPPAMAPBUFFER_H
+#define	KAPPAMAPBUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+// Kappa map kept as a structure of arrays: cells, faces and (small)
+// coefficients are stored in separate arrays, so an entry takes
+// 2 * sizeof(Id) + sizeof(Index) bytes instead of a padded tuple.
+// Used by all kappa map producers, converted to the SComplex kappa map
+// only when the complex is constructed (see SComplexFactory).
+// The arrays are split into chunks of CHUNK_SIZE entries, so that the
+// conversion releases the buffer while the tuples are written.
+template <typename IdT, typename IndexT = signed char>
+class KappaMapBuffer
+{
+public:
+
+    typedef IdT                 Id;
+    typedef IndexT              Index;
+
+    KappaMapBuffer();
+
+    void Append(const Id& cell, const Id& face, int coefficient);
+    // appends all the entries of other buffer
+    void Append(const KappaMapBuffer& other);
+
+    void Clear();
+    void Reserve(size_t entriesCount);
+    void Swap(KappaMapBuffer& other);
+
+    size_t Size() const;
+    bool Empty() const;
+    const Id& GetCell(size_t entry) const;
+    const Id& GetFace(size_t entry) const;
+    int GetCoefficient(size_t entry) const;
+
+    // replaces every id (of cells and faces) with newIds[id],
+    // order of the entries is kept
+    void Renumber(const std::vector<Id>& newIds);
+    // moves ids of consecutive ranges, ids in [oldOffsets[i], oldOffsets[i + 1])
+    // are shifted by newOffsets[i] - oldOffsets[i] (ranges may be empty)
+    void Renumber(const std::vector<Id>& oldOffsets, const std::vector<Id>& newOffsets);
+
+    // fills the kappa map of SComplex (a vector of (cell, face, coefficient)
+    // tuples), every chunk is released as soon as it is converted
+    template <typename KappaMap>
+    void MoveTo(KappaMap& kappaMap);
+
+private:
+
+    enum
+    {
+        CHUNK_BITS = 24,
+        CHUNK_SIZE = 1 << CHUNK_BITS,
+    };
+
+    static Id GetShiftedId(const Id& id, const std::vector<Id>& oldOffsets, const std::vector<Id>& newOffsets);
+
+    struct Chunk
+    {
+        std::vector<Id>     _cells;
+        std::vector<Id>     _faces;
+        std::vector<Index>  _coefficients;
+    };
+
+    std::vector<Chunk>  _chunks;
+    size_t              _size;
+};
+
+#include "KappaMapBuffer.hpp"
+
+#endif	/* KAPPAMAPBUFFER_H */
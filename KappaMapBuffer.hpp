@@ -0,0 +1,187 @@
+/*
+ * File:   KappaMapBuffer.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef KAPPAMAPBUFFER_HPP
+#define	KAPPAMAPBUFFER_HPP
+
+#include "KappaMapBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+template <typename IdT, typename IndexT>
+KappaMapBuffer<IdT, IndexT>::KappaMapBuffer()
+    : _size(0)
+{
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Append(const Id& cell, const Id& face, int coefficient)
+{
+    assert(coefficient >= std::numeric_limits<Index>::min());
+    assert(coefficient <= std::numeric_limits<Index>::max());
+    size_t chunkIndex = _size >> CHUNK_BITS;
+    if (chunkIndex == _chunks.size())
+    {
+        _chunks.push_back(Chunk());
+    }
+    Chunk& chunk = _chunks[chunkIndex];
+    chunk._cells.push_back(cell);
+    chunk._faces.push_back(face);
+    chunk._coefficients.push_back(static_cast<Index>(coefficient));
+    _size++;
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Append(const KappaMapBuffer& other)
+{
+    for (size_t i = 0; i < other._size; i++)
+    {
+        Append(other.GetCell(i), other.GetFace(i), other.GetCoefficient(i));
+    }
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Clear()
+{
+    _chunks.clear();
+    _size = 0;
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Reserve(size_t entriesCount)
+{
+    size_t chunksCount = (entriesCount + CHUNK_SIZE - 1) >> CHUNK_BITS;
+    if (chunksCount > _chunks.size())
+    {
+        _chunks.resize(chunksCount);
+    }
+    for (size_t i = 0; i < chunksCount; i++)
+    {
+        size_t chunkSize = std::min(entriesCount - (i << CHUNK_BITS), static_cast<size_t>(CHUNK_SIZE));
+        _chunks[i]._cells.reserve(chunkSize);
+        _chunks[i]._faces.reserve(chunkSize);
+        _chunks[i]._coefficients.reserve(chunkSize);
+    }
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Swap(KappaMapBuffer& other)
+{
+    _chunks.swap(other._chunks);
+    std::swap(_size, other._size);
+}
+
+template <typename IdT, typename IndexT>
+size_t KappaMapBuffer<IdT, IndexT>::Size() const
+{
+    return _size;
+}
+
+template <typename IdT, typename IndexT>
+bool KappaMapBuffer<IdT, IndexT>::Empty() const
+{
+    return _size == 0;
+}
+
+template <typename IdT, typename IndexT>
+const typename KappaMapBuffer<IdT, IndexT>::Id&
+KappaMapBuffer<IdT, IndexT>::GetCell(size_t entry) const
+{
+    assert(entry < _size);
+    return _chunks[entry >> CHUNK_BITS]._cells[entry & (CHUNK_SIZE - 1)];
+}
+
+template <typename IdT, typename IndexT>
+const typename KappaMapBuffer<IdT, IndexT>::Id&
+KappaMapBuffer<IdT, IndexT>::GetFace(size_t entry) const
+{
+    assert(entry < _size);
+    return _chunks[entry >> CHUNK_BITS]._faces[entry & (CHUNK_SIZE - 1)];
+}
+
+template <typename IdT, typename IndexT>
+int KappaMapBuffer<IdT, IndexT>::GetCoefficient(size_t entry) const
+{
+    assert(entry < _size);
+    return static_cast<int>(_chunks[entry >> CHUNK_BITS]._coefficients[entry & (CHUNK_SIZE - 1)]);
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Renumber(const std::vector<Id>& newIds)
+{
+    typename std::vector<Chunk>::iterator it = _chunks.begin();
+    typename std::vector<Chunk>::iterator itEnd = _chunks.end();
+    for ( ; it != itEnd; ++it)
+    {
+        std::vector<Id>& cells = it->_cells;
+        std::vector<Id>& faces = it->_faces;
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            assert(static_cast<size_t>(cells[i]) < newIds.size());
+            assert(static_cast<size_t>(faces[i]) < newIds.size());
+            cells[i] = newIds[cells[i]];
+            faces[i] = newIds[faces[i]];
+        }
+    }
+}
+
+template <typename IdT, typename IndexT>
+void KappaMapBuffer<IdT, IndexT>::Renumber(const std::vector<Id>& oldOffsets, const std::vector<Id>& newOffsets)
+{
+    assert(oldOffsets.size() == newOffsets.size() && !oldOffsets.empty());
+    typename std::vector<Chunk>::iterator it = _chunks.begin();
+    typename std::vector<Chunk>::iterator itEnd = _chunks.end();
+    for ( ; it != itEnd; ++it)
+    {
+        std::vector<Id>& cells = it->_cells;
+        std::vector<Id>& faces = it->_faces;
+        for (size_t i = 0; i < cells.size(); i++)
+        {
+            cells[i] = GetShiftedId(cells[i], oldOffsets, newOffsets);
+            faces[i] = GetShiftedId(faces[i], oldOffsets, newOffsets);
+        }
+    }
+}
+
+template <typename IdT, typename IndexT>
+typename KappaMapBuffer<IdT, IndexT>::Id
+KappaMapBuffer<IdT, IndexT>::GetShiftedId(const Id& id,
+                                          const std::vector<Id>& oldOffsets,
+                                          const std::vector<Id>& newOffsets)
+{
+    // empty ranges start where the next one does, so the id belongs
+    // to the last range starting at or before it
+    size_t range = std::upper_bound(oldOffsets.begin(), oldOffsets.end(), id) - oldOffsets.begin() - 1;
+    return newOffsets[range] + (id - oldOffsets[range]);
+}
+
+template <typename IdT, typename IndexT>
+template <typename KappaMap>
+void KappaMapBuffer<IdT, IndexT>::MoveTo(KappaMap& kappaMap)
+{
+    // pages of the reserved tuples are committed only when written, so
+    // at any moment there are converted tuples and not converted chunks,
+    // i.e. about sizeof(KappaMapEntry) bytes per entry and one chunk
+    typedef typename KappaMap::value_type KappaMapEntry;
+    kappaMap.clear();
+    kappaMap.reserve(_size);
+    typename std::vector<Chunk>::iterator it = _chunks.begin();
+    typename std::vector<Chunk>::iterator itEnd = _chunks.end();
+    for ( ; it != itEnd; ++it)
+    {
+        for (size_t i = 0; i < it->_cells.size(); i++)
+        {
+            kappaMap.push_back(KappaMapEntry(it->_cells[i], it->_faces[i], it->_coefficients[i]));
+        }
+        std::vector<Id>().swap(it->_cells);
+        std::vector<Id>().swap(it->_faces);
+        std::vector<Index>().swap(it->_coefficients);
+    }
+    Clear();
+}
+
+#endif	/* KAPPAMAPBUFFER_HPP */
@@ -7,23 +7,23 @@
 #define	KAPPAMAPSUPPLIER_H
 
 #include <vector>
-#include <boost/tuple/tuple.hpp>
 
 #include "DebugComplexType.h"
+#include "KappaMapBuffer.h"
 
-template <typename IdT = int, typename IndexT = int, typename DimT = int>
+template <typename IdT = int, typename IndexT = signed char, typename DimT = int>
 class KappaMapSupplier
 {
 public:
 
     typedef IdT                         Id;
     typedef IndexT                      Index;
-    typedef boost::tuple<Id, Id, Index> KappaMapEntry;
-    typedef std::vector<KappaMapEntry>  KappaMap;
+    typedef KappaMapBuffer<Id, Index>   KappaMap;
     typedef DimT                        Dim;
     typedef std::vector<Dim>            Dims;
 
-    static void Load(const char* filename, Dims& dims, KappaMap& kappaMap);
+    // cells of dimension greater than maxDim (if nonnegative) are skipped
+    static void Load(const char* filename, Dims& dims, KappaMap& kappaMap, int maxDim = -1);
     static void Create(DebugComplexType type, Dims& dims, KappaMap& kappaMap);
 
 private:
@@ -37,4 +37,4 @@ private:
 
 #include "KappaMapSupplier.hpp"
 
-#endif	/* KAPPAMAPSUPPLIER_H */
\ No newline at end of file
+#endif	/* KAPPAMAPSUPPLIER_H */
\ No newline at end of file
@@ -9,13 +9,16 @@
 #include "KappaMapSupplier.h"
 
 #include <fstream>
+#include <limits>
+#include <stdexcept>
 
 #include "FGLogger.h"
 
 template <typename IdT, typename IndexT, typename DimT>
 void KappaMapSupplier<IdT, IndexT, DimT>::Load(const char* filename,
                                                Dims& dims,
-                                               KappaMap& kappaMap)
+                                               KappaMap& kappaMap,
+                                               int maxDim)
 {
     std::ifstream input(filename);
     if (!input.is_open())
@@ -24,10 +27,13 @@ void KappaMapSupplier<IdT, IndexT, DimT>::Load(const char* filename,
     }
 
     dims.clear();
-    kappaMap.clear();
+    kappaMap.Clear();
     size_t topDim = 0;
     size_t totalCellsCount = 0;
     size_t kappaMapSize = 0;
+    // cells are numbered by dimension, so the skipped ones are at the end
+    size_t keptCellsCount = 0;
+    size_t keptKappaMapSize = 0;
 
     FGLogger logger;
     logger.Begin(FGLogger::Details, "reading kappa map");
@@ -39,14 +45,25 @@ void KappaMapSupplier<IdT, IndexT, DimT>::Load(const char* filename,
         input>>cellsCount;
         logger.Log(FGLogger::Details)<<cellsCount<<" cells in dim "<<dim<<std::endl;
         totalCellsCount += cellsCount;
+        // for every cell there is 2 boundary cells in each dimension
+        kappaMapSize += dim * cellsCount * 2;
+        if (maxDim >= 0 && dim > maxDim)
+        {
+            continue;
+        }
         for (int i = 0; i < cellsCount; i++)
         {
             dims.push_back(static_cast<Dim>(dim));
         }
-        // for every cell there is 2 boundary cells in each dimension
-        kappaMapSize += dim * cellsCount * 2;
+        keptCellsCount += cellsCount;
+        keptKappaMapSize += dim * cellsCount * 2;
     }
     logger.Log(FGLogger::Details)<<"total cells count = "<<totalCellsCount<<std::endl;
+    if (keptCellsCount < totalCellsCount)
+    {
+        logger.Log(FGLogger::Details)<<"skipping cells of dim > "<<maxDim<<", "<<keptCellsCount<<" cells left"<<std::endl;
+    }
+    kappaMap.Reserve(keptKappaMapSize);
 
     for (int i = 0; i < kappaMapSize; i++)
     {
@@ -56,9 +73,15 @@ void KappaMapSupplier<IdT, IndexT, DimT>::Load(const char* filename,
         input>>cell;
         input>>boundary;
         input>>index;
-        kappaMap.push_back(KappaMapEntry(static_cast<Id>(cell),
-                                         static_cast<Id>(boundary),
-                                         static_cast<Index>(index)));
+        if (index < std::numeric_limits<Index>::min() || index > std::numeric_limits<Index>::max())
+        {
+            throw std::runtime_error(std::string("coefficient out of range in file ") + filename);
+        }
+        if (cell >= keptCellsCount)
+        {
+            continue;
+        }
+        kappaMap.Append(static_cast<Id>(cell), static_cast<Id>(boundary), index);
     }
     input.close();
     logger.End("data read successfully");
@@ -70,7 +93,7 @@ void KappaMapSupplier<IdT, IndexT, DimT>::Create(DebugComplexType type,
                                                  KappaMap& kappaMap)
 {
     dims.clear();
-    kappaMap.clear();
+    kappaMap.Clear();
     switch (type)
     {
         case DCT_S1:
@@ -104,12 +127,12 @@ void KappaMapSupplier<IdT, IndexT, DimT>::FillS1(Dims& dims, KappaMap& kappaMap)
     dims.push_back(Dim(1)); // 3 - [0, 1]
     dims.push_back(Dim(1)); // 4 - [1, 2]
     dims.push_back(Dim(1)); // 5 - [0, 2]
-    kappaMap.push_back(KappaMapEntry(3, 0, -1));
-    kappaMap.push_back(KappaMapEntry(3, 1, 1));
-    kappaMap.push_back(KappaMapEntry(4, 1, -1));
-    kappaMap.push_back(KappaMapEntry(4, 2, 1));
-    kappaMap.push_back(KappaMapEntry(5, 2, -1));
-    kappaMap.push_back(KappaMapEntry(5, 0, 1));
+    kappaMap.Append(3, 0, -1);
+    kappaMap.Append(3, 1, 1);
+    kappaMap.Append(4, 1, -1);
+    kappaMap.Append(4, 2, 1);
+    kappaMap.Append(5, 2, -1);
+    kappaMap.Append(5, 0, 1);
 }
 
 template <typename IdT, typename IndexT, typename DimT>
@@ -131,30 +154,30 @@ void KappaMapSupplier<IdT, IndexT, DimT>::FillS2(Dims& dims, KappaMap& kappaMap)
     dims.push_back(Dim(2)); // 11 - [0, 1, 3]
     dims.push_back(Dim(2)); // 12 - [0, 2, 3]
     dims.push_back(Dim(2)); // 13 - [1, 2, 3]
-    kappaMap.push_back(KappaMapEntry(4, 0, -1));
-    kappaMap.push_back(KappaMapEntry(4, 1, 1));
-    kappaMap.push_back(KappaMapEntry(5, 0, -1));
-    kappaMap.push_back(KappaMapEntry(5, 2, 1));
-    kappaMap.push_back(KappaMapEntry(6, 0, -1));
-    kappaMap.push_back(KappaMapEntry(6, 3, 1));
-    kappaMap.push_back(KappaMapEntry(7, 1, -1));
-    kappaMap.push_back(KappaMapEntry(7, 2, 1));
-    kappaMap.push_back(KappaMapEntry(8, 1, -1));
-    kappaMap.push_back(KappaMapEntry(8, 3, 1));
-    kappaMap.push_back(KappaMapEntry(9, 2, -1));
-    kappaMap.push_back(KappaMapEntry(9, 3, 1));
-    kappaMap.push_back(KappaMapEntry(10, 4, 1));
-    kappaMap.push_back(KappaMapEntry(10, 5, -1));
-    kappaMap.push_back(KappaMapEntry(10, 7, 1));
-    kappaMap.push_back(KappaMapEntry(11, 4, 1));
-    kappaMap.push_back(KappaMapEntry(11, 6, -1));
-    kappaMap.push_back(KappaMapEntry(11, 8, 1));
-    kappaMap.push_back(KappaMapEntry(12, 5, 1));
-    kappaMap.push_back(KappaMapEntry(12, 6, -1));
-    kappaMap.push_back(KappaMapEntry(12, 9, 1));
-    kappaMap.push_back(KappaMapEntry(13, 7, 1));
-    kappaMap.push_back(KappaMapEntry(13, 8, -1));
-    kappaMap.push_back(KappaMapEntry(13, 9, 1));
+    kappaMap.Append(4, 0, -1);
+    kappaMap.Append(4, 1, 1);
+    kappaMap.Append(5, 0, -1);
+    kappaMap.Append(5, 2, 1);
+    kappaMap.Append(6, 0, -1);
+    kappaMap.Append(6, 3, 1);
+    kappaMap.Append(7, 1, -1);
+    kappaMap.Append(7, 2, 1);
+    kappaMap.Append(8, 1, -1);
+    kappaMap.Append(8, 3, 1);
+    kappaMap.Append(9, 2, -1);
+    kappaMap.Append(9, 3, 1);
+    kappaMap.Append(10, 4, 1);
+    kappaMap.Append(10, 5, -1);
+    kappaMap.Append(10, 7, 1);
+    kappaMap.Append(11, 4, 1);
+    kappaMap.Append(11, 6, -1);
+    kappaMap.Append(11, 8, 1);
+    kappaMap.Append(12, 5, 1);
+    kappaMap.Append(12, 6, -1);
+    kappaMap.Append(12, 9, 1);
+    kappaMap.Append(13, 7, 1);
+    kappaMap.Append(13, 8, -1);
+    kappaMap.Append(13, 9, 1);
 }
 
 template <typename IdT, typename IndexT, typename DimT>
@@ -177,18 +200,18 @@ void KappaMapSupplier<IdT, IndexT, DimT>::FillSkeleton(Dims& dims, KappaMap& kap
     dims.push_back(Dim(1)); // 7 - [1, 2]
     dims.push_back(Dim(1)); // 8 - [1, 3]
     dims.push_back(Dim(1)); // 9 - [2, 3]
-    kappaMap.push_back(KappaMapEntry(4, 0, -1));
-    kappaMap.push_back(KappaMapEntry(4, 1, 1));
-    kappaMap.push_back(KappaMapEntry(5, 0, -1));
-    kappaMap.push_back(KappaMapEntry(5, 2, 1));
-    kappaMap.push_back(KappaMapEntry(6, 0, -1));
-    kappaMap.push_back(KappaMapEntry(6, 3, 1));
-    kappaMap.push_back(KappaMapEntry(7, 1, -1));
-    kappaMap.push_back(KappaMapEntry(7, 2, 1));
-    kappaMap.push_back(KappaMapEntry(8, 1, -1));
-    kappaMap.push_back(KappaMapEntry(8, 3, 1));
-    kappaMap.push_back(KappaMapEntry(9, 2, -1));
-    kappaMap.push_back(KappaMapEntry(9, 3, 1));
+    kappaMap.Append(4, 0, -1);
+    kappaMap.Append(4, 1, 1);
+    kappaMap.Append(5, 0, -1);
+    kappaMap.Append(5, 2, 1);
+    kappaMap.Append(6, 0, -1);
+    kappaMap.Append(6, 3, 1);
+    kappaMap.Append(7, 1, -1);
+    kappaMap.Append(7, 2, 1);
+    kappaMap.Append(8, 1, -1);
+    kappaMap.Append(8, 3, 1);
+    kappaMap.Append(9, 2, -1);
+    kappaMap.Append(9, 3, 1);
 }
 
 template <typename IdT, typename IndexT, typename DimT>
@@ -10,6 +10,9 @@
 #include <boost/shared_ptr.hpp>
 
 #include "DebugComplexType.h"
+#include "FGOptions.h"
+#include "InlineVector.h"
+#include "WordArena.h"
 
 template <typename Traits>
 class NotReducedSComplexSupplier
@@ -36,16 +39,17 @@ public:
     typedef std::set<Id>                        Cells;
     typedef std::vector<Cells>                  CellsByDim;
     typedef std::vector<std::pair<Id, int> >    Chain;
+    typedef WordArena<Id>                       Chains;
 
-    NotReducedSComplexSupplier(const char* filename);
-    NotReducedSComplexSupplier(DebugComplexType type);
-    NotReducedSComplexSupplier(InputSComplexPtr inputSComplex);
+    NotReducedSComplexSupplier(const char* filename, const FGOptions& options = FGOptions());
+    NotReducedSComplexSupplier(DebugComplexType type, const FGOptions& options = FGOptions());
+    NotReducedSComplexSupplier(InputSComplexPtr inputSComplex, const FGOptions& options = FGOptions());
     
-    bool GetCells(CellsByDim& cellsByDim, std::map<Id, Chain>& _2Boundaries);
+    bool GetCells(CellsByDim& cellsByDim, Chains& _2Boundaries);
     Chain GetBoundary(const Id& cellId);
 
     template <typename ComplexType>
-    std::list<std::pair<typename ComplexType::Id, int> >
+    InlineVector<std::pair<typename ComplexType::Id, int>, 4>
     GetOrdered2Boundary(ComplexType* complex, const typename ComplexType::Id& cellId);
 
     void PrintDebug();
@@ -53,6 +57,7 @@ public:
 private:
 
     InputSComplexPtr    _complex;
+    FGOptions           _options;
 };
 
 #include "NotReducedSComplexSupplier.hpp"
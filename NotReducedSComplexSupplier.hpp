@@ -11,26 +11,32 @@
 #include "SComplexFactory.h"
 
 template <typename Traits>
-NotReducedSComplexSupplier<Traits>::NotReducedSComplexSupplier(const char* filename)
+NotReducedSComplexSupplier<Traits>::NotReducedSComplexSupplier(const char* filename,
+                                                               const FGOptions& options)
+    : _options(options)
 {
-    _complex = SComplexFactory<InputSComplex>::Load(filename);
+    _complex = SComplexFactory<InputSComplex>::Load(filename, _options._skeletonDim);
 }
 
 template <typename Traits>
-NotReducedSComplexSupplier<Traits>::NotReducedSComplexSupplier(DebugComplexType type)
+NotReducedSComplexSupplier<Traits>::NotReducedSComplexSupplier(DebugComplexType type,
+                                                               const FGOptions& options)
+    : _options(options)
 {
     _complex = SComplexFactory<InputSComplex>::Create(type);
 }
 
 template <typename Traits>
-NotReducedSComplexSupplier<Traits>::NotReducedSComplexSupplier(InputSComplexPtr inputSComplex)
+NotReducedSComplexSupplier<Traits>::NotReducedSComplexSupplier(InputSComplexPtr inputSComplex,
+                                                               const FGOptions& options)
     : _complex(inputSComplex)
+    , _options(options)
 {
 }
 
 template <typename Traits>
 bool NotReducedSComplexSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
-                                                  std::map<Id, Chain>& _2Boundaries)
+                                                  Chains& _2Boundaries)
 {
     int maxDim = static_cast<int>(_complex->getDim());
     cellsByDim.resize(maxDim + 1);
@@ -47,7 +53,7 @@ bool NotReducedSComplexSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
     }
 
     // if there are some 2-cells, take its boundaries
-    _2Boundaries.clear();
+    _2Boundaries.Clear();
     if (cellsByDim.size() > 2)
     {
         Cells& _2cells = cellsByDim[2];
@@ -55,8 +61,14 @@ bool NotReducedSComplexSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
         typename Cells::iterator itEnd = _2cells.end();
         for ( ; it != itEnd; ++it)
         {
-            std::list<std::pair<Id, int> > bdList = GetOrdered2Boundary(_complex.get(), *it);
-            _2Boundaries[*it].assign(bdList.begin(), bdList.end());
+            InlineVector<std::pair<Id, int>, 4> bdList = GetOrdered2Boundary(_complex.get(), *it);
+            typename InlineVector<std::pair<Id, int>, 4>::iterator jt = bdList.begin();
+            typename InlineVector<std::pair<Id, int>, 4>::iterator jtEnd = bdList.end();
+            for ( ; jt != jtEnd; ++jt)
+            {
+                _2Boundaries.Append(jt->first, jt->second);
+            }
+            _2Boundaries.EndWord();
         }
     }
     return cellsByDim.size() > 0;
@@ -87,7 +99,7 @@ NotReducedSComplexSupplier<Traits>::GetBoundary(const Id& cellId)
 
 template <typename Traits>
 template <typename ComplexType>
-std::list<std::pair<typename ComplexType::Id, int> >
+InlineVector<std::pair<typename ComplexType::Id, int>, 4>
 NotReducedSComplexSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
                                             const typename ComplexType::Id& cellId)
 {
@@ -95,7 +107,7 @@ NotReducedSComplexSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
     typedef typename ComplexType::Cell Cell;
     typedef typename ComplexType::Iterators::BdCells BdCells;
     Cell cell = (*complex)[cellId];
-    std::list<std::pair<Id, int> > boundary;
+    InlineVector<std::pair<Id, int>, 4> boundary;
     BdCells bdCells = complex->iterators().bdCells(cell);
     typename BdCells::iterator it = bdCells.begin();
     typename BdCells::iterator itEnd = bdCells.end();
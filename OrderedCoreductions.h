@@ -0,0 +1,44 @@
+/*
+ * File:   OrderedCoreductions.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef ORDEREDCOREDUCTIONS_H
+#define	ORDEREDCOREDUCTIONS_H
+
+#include <boost/shared_ptr.hpp>
+
+#include "FGLogger.h"
+#include "FGOptions.h"
+#include "SComplexFactory.h"
+
+// Coreductions of a complex created from a kappa map with cells ordered
+// by the policy of the options (see CellsOrder). With the random order
+// every restart uses its own seed and the run which leaves the least
+// extracted cells is kept.
+template <typename SComplexT, typename StrategyT, typename AlgorithmT>
+class OrderedCoreductions
+{
+public:
+
+    typedef SComplexT                                   SComplexType;
+    typedef boost::shared_ptr<SComplexType>             SComplexPtr;
+    typedef StrategyT                                   Strategy;
+    typedef AlgorithmT                                  Algorithm;
+    typedef boost::shared_ptr<Algorithm>                AlgorithmPtr;
+
+    typedef SComplexFactory<SComplexType>               Factory;
+    typedef typename Factory::Id                        Id;
+    typedef typename Factory::Dim                       Dim;
+    typedef typename Factory::Dims                      Dims;
+    typedef typename Factory::KappaMapBufferType        KappaMap;
+
+    // kappa map is consumed, complex and algorithm receive the best run
+    // (algorithm refers to the complex)
+    static void Perform(const FGOptions& options, FGLogger& logger, Dims& dims, KappaMap& kappaMap,
+                        SComplexPtr& complex, AlgorithmPtr& algorithm);
+};
+
+#include "OrderedCoreductions.hpp"
+
+#endif	/* ORDEREDCOREDUCTIONS_H */
@@ -0,0 +1,76 @@
+/*
+ * File:   OrderedCoreductions.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef ORDEREDCOREDUCTIONS_HPP
+#define	ORDEREDCOREDUCTIONS_HPP
+
+#include "OrderedCoreductions.h"
+
+#include <algorithm>
+
+#include "CellsOrder.h"
+
+template <typename SComplexT, typename StrategyT, typename AlgorithmT>
+void OrderedCoreductions<SComplexT, StrategyT, AlgorithmT>::Perform(const FGOptions& options,
+                                                                   FGLogger& logger,
+                                                                   Dims& dims,
+                                                                   KappaMap& kappaMap,
+                                                                   SComplexPtr& complex,
+                                                                   AlgorithmPtr& algorithm)
+{
+    OrderPolicy policy = options._orderPolicy;
+    int restartsCount = policy == OP_Random ? std::max(1, options._orderRestarts) : 1;
+    size_t bestExtractedCount = 0;
+    algorithm.reset();
+    complex.reset();
+    for (int restart = 0; restart < restartsCount; restart++)
+    {
+        // every restart but the last one works on a copy of the kappa-map
+        Dims orderedDims;
+        KappaMap orderedKappaMap;
+        if (restart + 1 < restartsCount)
+        {
+            orderedDims = dims;
+            orderedKappaMap.Append(kappaMap);
+        }
+        else
+        {
+            orderedDims.swap(dims);
+            orderedKappaMap.Swap(kappaMap);
+        }
+        CellsOrder<Id, Dim>::Apply(policy, static_cast<unsigned int>(restart), orderedDims, orderedKappaMap);
+
+        logger.Begin(FGLogger::Details, "creating SComplex from kappa-map");
+        SComplexPtr runComplex = Factory::Create(orderedDims, orderedKappaMap);
+        logger.End();
+
+        logger.Begin(FGLogger::Details, "performing coreductions");
+        AlgorithmPtr runAlgorithm = AlgorithmPtr(new Algorithm(new Strategy(*runComplex)));
+        size_t reducedCount = (*runAlgorithm)();
+        int time = logger.End("coreductions finished");
+        size_t extractedCount = runAlgorithm->getExtractedSignature().size();
+        if (logger.PrintCoreducedCellsCount())
+        {
+            logger.Log(FGLogger::Details)<<"order: "<<CellsOrder<Id, Dim>::GetName(policy);
+            logger.Log(FGLogger::Details)<<", run "<<restart + 1<<" of "<<restartsCount<<std::endl;
+            logger.Log(FGLogger::Details)<<"number of reduced pairs: "<<reducedCount<<std::endl;
+            logger.Log(FGLogger::Details)<<"number of extracted cells: "<<extractedCount<<std::endl;
+            logger.Log(FGLogger::Details)<<"coreductions time: "<<time<<" ms"<<std::endl;
+        }
+        if (!algorithm || extractedCount < bestExtractedCount)
+        {
+            // algorithm refers to the complex, so it is replaced first
+            algorithm = runAlgorithm;
+            complex = runComplex;
+            bestExtractedCount = extractedCount;
+        }
+    }
+    if (restartsCount > 1)
+    {
+        logger.Log(FGLogger::Details)<<"best number of extracted cells: "<<bestExtractedCount<<std::endl;
+    }
+}
+
+#endif	/* ORDEREDCOREDUCTIONS_HPP */
@@ -0,0 +1,85 @@
+/*
+ * File:   QuotientAKQSupplier.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef QUOTIENTAKQSUPPLIER_H
+#define	QUOTIENTAKQSUPPLIER_H
+
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <capd/complex/Coreduction.h>
+#include <capd/complex/AKQStrategy.hpp>
+
+#include "FGLogger.h"
+#include "FGOptions.h"
+#include "InlineVector.h"
+#include "KappaMapBuffer.h"
+#include "WordArena.h"
+
+// Common part of the suppliers which build the kappa-map of a quotient
+// complex themselves: creates the complex from the kappa-map, performs
+// AKQ reduction on it and supplies cells and boundaries of the result.
+template <typename Traits>
+class QuotientAKQSupplier
+{
+public:
+
+    typedef typename Traits::GeneralSComplexType    InputSComplex;
+    typedef typename Traits::GeneralSComplexType    OutputSComplex;
+
+    typedef typename Traits::ScalarType             Scalar;
+
+    typedef Traits                                  HomologyTraits;
+    typedef typename InputSComplex::Id              Id;
+    typedef typename OutputSComplex::Cell           Cell;
+    typedef std::set<Id>                            Cells;
+    typedef std::vector<Cells>                      CellsByDim;
+    typedef std::vector<std::pair<Id, int> >        Chain;
+    typedef WordArena<Id>                           Chains;
+
+    bool GetCells(CellsByDim& cellsByDim, Chains& _2Boundaries);
+    Chain GetBoundary(const Id& cellId);
+
+    template <typename ComplexType>
+    InlineVector<std::pair<typename ComplexType::Id, int>, 4>
+    GetOrdered2Boundary(ComplexType* complex, const typename ComplexType::Id& cellId);
+
+    void PrintDebug();
+
+protected:
+
+    typedef boost::shared_ptr<InputSComplex>        InputSComplexPtr;
+    typedef typename Traits::IntType                Int;
+
+    typedef typename InputSComplex::Dim             Dim;
+    typedef typename InputSComplex::Dims            Dims;
+    typedef KappaMapBuffer<Id>                      KappaMap;
+    typedef typename OutputSComplex::Iterators::DimCells DimCells;
+    typedef typename OutputSComplex::Iterators::BdCells  BdCells;
+
+    typedef capd::complex::AKQReduceStrategy<InputSComplex, OutputSComplex, Scalar> Strategy;
+    typedef capd::complex::Coreduction<Strategy, Scalar, Int> Algorithm;
+    typedef boost::shared_ptr<Algorithm>            AlgorithmPtr;
+
+    QuotientAKQSupplier(const FGOptions& options);
+
+    // creates the complex and performs coreductions in the order given
+    // by the options, keeping the run which leaves the least extracted cells
+    void CreateAlgorithm(Dims& dims, KappaMap& kappaMap);
+    // caches boundaries of 1-cells and frees the complexes and the algorithm
+    void ReleaseComplexes(const CellsByDim& cellsByDim);
+
+    InputSComplexPtr    _complex;
+    AlgorithmPtr        _algorithm;
+    // boundaries of 1-cells kept after the complexes are released
+    std::map<Id, Chain> _1Boundaries;
+    FGLogger            _logger;
+    FGOptions           _options;
+};
+
+#include "QuotientAKQSupplier.hpp"
+
+#endif	/* QUOTIENTAKQSUPPLIER_H */
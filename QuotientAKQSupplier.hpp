@@ -0,0 +1,161 @@
+/*
+ * File:   QuotientAKQSupplier.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef QUOTIENTAKQSUPPLIER_HPP
+#define	QUOTIENTAKQSUPPLIER_HPP
+
+#include "QuotientAKQSupplier.h"
+
+#include <cassert>
+
+#include "AKQHomotopicPaths.h"
+#include "HomologyHelpers.h"
+#include "OrderedCoreductions.h"
+
+template <typename Traits>
+QuotientAKQSupplier<Traits>::QuotientAKQSupplier(const FGOptions& options)
+    : _options(options)
+{
+}
+
+template <typename Traits>
+void QuotientAKQSupplier<Traits>::CreateAlgorithm(Dims& dims, KappaMap& kappaMap)
+{
+    OrderedCoreductions<InputSComplex, Strategy, Algorithm>::Perform(_options, _logger, dims, kappaMap,
+                                                                     _complex, _algorithm);
+}
+
+template <typename Traits>
+bool QuotientAKQSupplier<Traits>::GetCells(CellsByDim& cellsByDim,
+                                           Chains& _2Boundaries)
+{
+    OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
+    int maxDim = static_cast<int>(outputComplex->getDim());
+    cellsByDim.resize(maxDim + 1);
+    for (int dim = 0; dim <= maxDim; dim++)
+    {
+        DimCells dimCells = outputComplex->iterators().dimCells(static_cast<Dim>(dim));
+        typename DimCells::iterator it = dimCells.begin();
+        typename DimCells::iterator itEnd = dimCells.end();
+        for ( ; it != itEnd; ++it)
+        {
+            cellsByDim[dim].insert(it->getId());
+        }
+    }
+
+    // if there are some 2-cells, take its (homotopic) boundaries
+    _2Boundaries.Clear();
+    if (cellsByDim.size() > 2)
+    {
+        _logger.Begin(FGLogger::Details, "computing homotopic boundaries");
+        AKQHomotopicPaths<QuotientAKQSupplier<Traits> > homotopicPaths(this, _algorithm->getStrategy());
+        Cells& _2cells = cellsByDim[2];
+        std::vector<Id> cells(_2cells.begin(), _2cells.end());
+        homotopicPaths.GetHomotopicBoundaries(cells, _2Boundaries, _options._threadsCount);
+        _logger.End();
+
+        HomotopicPathsStats stats = homotopicPaths.GetStats();
+        _logger.Log(FGLogger::Details)<<"homotopic paths statistics:"<<std::endl;
+        stats.Print(_logger.Log(FGLogger::Details));
+        if (_options._statsFilename.size() > 0 && !stats.Dump(_options._statsFilename))
+        {
+            _logger.Log(FGLogger::Output)<<"cannot write statistics to "<<_options._statsFilename<<std::endl;
+        }
+    }
+    if (_options._leanMemory)
+    {
+        ReleaseComplexes(cellsByDim);
+    }
+    return cellsByDim.size() > 0;
+}
+
+template <typename Traits>
+void QuotientAKQSupplier<Traits>::ReleaseComplexes(const CellsByDim& cellsByDim)
+{
+    _logger.Begin(FGLogger::Details, "releasing complexes");
+    // only boundaries of 1-cells are needed later (for the spanning tree)
+    if (cellsByDim.size() > 1)
+    {
+        typename Cells::const_iterator it = cellsByDim[1].begin();
+        typename Cells::const_iterator itEnd = cellsByDim[1].end();
+        for ( ; it != itEnd; ++it)
+        {
+            _1Boundaries[*it] = GetBoundary(*it);
+        }
+    }
+    // algorithm (with its strategy and output complex) refers to the input complex
+    _algorithm.reset();
+    _complex.reset();
+    _logger.End();
+}
+
+template <typename Traits>
+typename QuotientAKQSupplier<Traits>::Chain
+QuotientAKQSupplier<Traits>::GetBoundary(const Id& cellId)
+{
+    if (!_algorithm)
+    {
+        typename std::map<Id, Chain>::const_iterator it = _1Boundaries.find(cellId);
+        assert(it != _1Boundaries.end());
+        return it->second;
+    }
+    OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
+    Cell cell = (*outputComplex)[cellId];
+    Chain boundary;
+    BdCells bdCells = outputComplex->iterators().bdCells(cell);
+    typename BdCells::iterator it = bdCells.begin();
+    typename BdCells::iterator itEnd = bdCells.end();
+    for ( ; it != itEnd; ++it)
+    {
+        int ci = outputComplex->coincidenceIndex(cell, *it);
+        assert(ci != 0);
+        boundary.push_back(std::pair<Id, int>(it->getId(), ci));
+    }
+    return boundary;
+}
+
+template <typename Traits>
+template <typename ComplexType>
+InlineVector<std::pair<typename ComplexType::Id, int>, 4>
+QuotientAKQSupplier<Traits>::GetOrdered2Boundary(ComplexType* complex,
+                                                 const typename ComplexType::Id& cellId)
+{
+    typedef typename ComplexType::Id Id;
+    typedef typename ComplexType::Cell Cell;
+    typedef typename ComplexType::Iterators::BdCells BdCells;
+    Cell cell = (*complex)[cellId];
+    InlineVector<std::pair<Id, int>, 4> boundary;
+    BdCells bdCells = complex->iterators().bdCells(cell);
+    typename BdCells::iterator it = bdCells.begin();
+    typename BdCells::iterator itEnd = bdCells.end();
+    for( ; it != itEnd; ++it)
+    {
+        int ci = complex->coincidenceIndex(cell, *it);
+        assert(ci != 0);
+        boundary.push_back(std::pair<Id, int>(it->getId(), ci));
+    }
+    return boundary;
+}
+
+template <typename Traits>
+void QuotientAKQSupplier<Traits>::PrintDebug()
+{
+    if (!_algorithm)
+    {
+        _logger.Log(FGLogger::Debug)<<"complexes released"<<std::endl;
+        return;
+    }
+    _logger.Log(FGLogger::Debug)<<"extracted signature:"<<std::endl<<_algorithm->getExtractedSignature()<<std::endl;
+
+    OutputSComplex* outputComplex = _algorithm->getStrategy()->getOutputComplex();
+    std::vector<int> betti = HomologyHelpers<Traits>::GetHomologySignature(outputComplex);
+    _logger.Log(FGLogger::Debug)<<"homology signature:"<<std::endl;
+    for (size_t i = 0; i < betti.size(); ++i)
+    {
+        _logger.Log(FGLogger::Debug)<<"H_"<<i<<" = Z^"<<betti[i]<<std::endl;
+    }
+}
+
+#endif	/* QUOTIENTAKQSUPPLIER_HPP */
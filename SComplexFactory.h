@@ -16,6 +16,7 @@ using namespace  capd::complex;
 #include <boost/shared_ptr.hpp>
 
 #include "DebugComplexType.h"
+#include "KappaMapBuffer.h"
 
 
 template <typename SComplexType>
@@ -34,11 +35,22 @@ public:
     typedef CRef<CubCellSet>                        CubCellSetPtr;
     typedef typename CubSComplex<DIM>::BCubSet      CubSet;
     typedef CRef<CubSet>                            CubSetPtr;
+    typedef int                                     Id;
+    typedef int                                     Dim;
+    typedef std::vector<Dim>                        Dims;
+    typedef KappaMapBuffer<Id>                      KappaMapBufferType;
 
-    static SComplexPtr Load(const char* filename);
+    // cubical sets are given by full cubes, so skeletonDim is ignored
+    static SComplexPtr Load(const char* filename, int skeletonDim = -1);
     static SComplexPtr Create(DebugComplexType type);
     static SComplexPtr Create(CubCellSetPtr cubCellSet);
     static SComplexPtr Create(CubSetPtr cubSet);
+
+    // cells of cubical complexes are ordered by their bitmaps,
+    // no kappa map is ever given (see SComplexFactory<SComplex<Traits> >)
+    static bool LoadKappaMap(const char* filename, int skeletonDim, Dims& dims, KappaMapBufferType& kappaMap);
+    static bool CreateKappaMap(DebugComplexType type, Dims& dims, KappaMapBufferType& kappaMap);
+    static SComplexPtr Create(Dims& dims, KappaMapBufferType& kappaMap);
 };
 
 template <>
@@ -51,10 +63,20 @@ public:
     typedef int                             Id;
     typedef std::set<Id>                    Simplex;
     typedef std::vector<Simplex>            Simplices;
+    typedef int                             Dim;
+    typedef std::vector<Dim>                Dims;
+    typedef KappaMapBuffer<Id>              KappaMapBufferType;
 
-    static SComplexPtr Load(const char* filename);
+    // only faces of dimension up to skeletonDim (if nonnegative) are created
+    static SComplexPtr Load(const char* filename, int skeletonDim = -1);
     static SComplexPtr Create(DebugComplexType type);
     static SComplexPtr Create(Simplices& simplices);
+
+    // cells of simplicial complexes are ordered by the complex itself,
+    // no kappa map is ever given (see SComplexFactory<SComplex<Traits> >)
+    static bool LoadKappaMap(const char* filename, int skeletonDim, Dims& dims, KappaMapBufferType& kappaMap);
+    static bool CreateKappaMap(DebugComplexType type, Dims& dims, KappaMapBufferType& kappaMap);
+    static SComplexPtr Create(Dims& dims, KappaMapBufferType& kappaMap);
 };
 
 template <typename Traits>
@@ -68,10 +90,21 @@ public:
     typedef typename SComplexType::Dim      Dim;
     typedef typename SComplexType::Dims     Dims;
     typedef typename SComplexType::KappaMap KappaMap;
+    typedef KappaMapBuffer<Id>              KappaMapBufferType;
 
-    static SComplexPtr Load(const char* filename);
+    // cells of dimension greater than skeletonDim (if nonnegative) are
+    // skipped when reading kappa maps
+    static SComplexPtr Load(const char* filename, int skeletonDim = -1);
     static SComplexPtr Create(DebugComplexType type);
     static SComplexPtr Create(Dims& dims, KappaMap& kappaMap);
+    // consumes the buffer (it is empty afterwards)
+    static SComplexPtr Create(Dims& dims, KappaMapBufferType& kappaMap);
+
+    // kappa map the complex would be created from (its cells can be
+    // renumbered then, see CellsOrder), false if the input is not given
+    // by a kappa map (e.g. cubes read by SComplexReader)
+    static bool LoadKappaMap(const char* filename, int skeletonDim, Dims& dims, KappaMapBufferType& kappaMap);
+    static bool CreateKappaMap(DebugComplexType type, Dims& dims, KappaMapBufferType& kappaMap);
 
 private:
 
@@ -18,7 +18,7 @@
 
 template <int DIM>
 typename SComplexFactory<CubSComplex<DIM> >::SComplexPtr
-SComplexFactory<CubSComplex<DIM> >::Load(const char* filename)
+SComplexFactory<CubSComplex<DIM> >::Load(const char* filename, int skeletonDim)
 {
     //CubCellSetPtr cubCellSet = CubCellSetFactory<CubCellSet>::Load(filename, true);
     //return Create(cubCellSet);
@@ -64,11 +64,32 @@ SComplexFactory<CubSComplex<DIM> >::Create(CubSetPtr cubSet)
     return complex;
 }
 
+template <int DIM>
+bool SComplexFactory<CubSComplex<DIM> >::LoadKappaMap(const char* filename, int skeletonDim,
+                                                      Dims& dims, KappaMapBufferType& kappaMap)
+{
+    return false;
+}
+
+template <int DIM>
+bool SComplexFactory<CubSComplex<DIM> >::CreateKappaMap(DebugComplexType type,
+                                                        Dims& dims, KappaMapBufferType& kappaMap)
+{
+    return false;
+}
+
+template <int DIM>
+typename SComplexFactory<CubSComplex<DIM> >::SComplexPtr
+SComplexFactory<CubSComplex<DIM> >::Create(Dims& dims, KappaMapBufferType& kappaMap)
+{
+    throw std::logic_error("not implemented");
+}
+
 SComplexFactory<SimplexSComplex>::SComplexPtr
-SComplexFactory<SimplexSComplex>::Load(const char* filename)
+SComplexFactory<SimplexSComplex>::Load(const char* filename, int skeletonDim)
 {
     Simplices simplices;
-    SimplicesSupplier<Id>::Load(filename, simplices);
+    SimplicesSupplier<Id>::Load(filename, simplices, skeletonDim);
     return Create(simplices);
 }
 
@@ -93,36 +114,72 @@ SComplexFactory<SimplexSComplex>::Create(Simplices& simplices)
     return complex;
 }
 
+bool SComplexFactory<SimplexSComplex>::LoadKappaMap(const char* filename, int skeletonDim,
+                                                    Dims& dims, KappaMapBufferType& kappaMap)
+{
+    return false;
+}
+
+bool SComplexFactory<SimplexSComplex>::CreateKappaMap(DebugComplexType type,
+                                                      Dims& dims, KappaMapBufferType& kappaMap)
+{
+    return false;
+}
+
+SComplexFactory<SimplexSComplex>::SComplexPtr
+SComplexFactory<SimplexSComplex>::Create(Dims& dims, KappaMapBufferType& kappaMap)
+{
+    throw std::logic_error("not implemented");
+}
+
 template <typename Traits>
 typename SComplexFactory<SComplex<Traits> >::SComplexPtr
-SComplexFactory<SComplex<Traits> >::Load(const char* filename)
+SComplexFactory<SComplex<Traits> >::Load(const char* filename, int skeletonDim)
 {
     Dims dims;
-    KappaMap kappaMap;
-    SComplexReader<Traits> reader;
+    KappaMapBufferType kappaMap;
+    if (!LoadKappaMap(filename, skeletonDim, dims, kappaMap))
+    {
+        SComplexReader<Traits> reader;
+        return reader(filename, 3, 1);
+    }
+    return Create(dims, kappaMap);
+}
+
+template <typename Traits>
+typename SComplexFactory<SComplex<Traits> >::SComplexPtr
+SComplexFactory<SComplex<Traits> >::Create(DebugComplexType type)
+{
+    Dims dims;
+    KappaMapBufferType kappaMap;
+    CreateKappaMap(type, dims, kappaMap);
+    return Create(dims, kappaMap);
+}
+
+template <typename Traits>
+bool SComplexFactory<SComplex<Traits> >::LoadKappaMap(const char* filename, int skeletonDim,
+                                                      Dims& dims, KappaMapBufferType& kappaMap)
+{
     FileType fileType = DetermineFileType(filename);
     switch (fileType)
     {
         case FT_KappaMap:
-            KappaMapSupplier<Id, int, Dim>::Load(filename, dims, kappaMap);
-            break;
+            KappaMapSupplier<Id, signed char, Dim>::Load(filename, dims, kappaMap, skeletonDim);
+            return true;
         case FT_Cubes:
-            return reader(filename, 3, 1);
+            return false;
         case FT_Simplices:
         default:
             throw std::logic_error("not implemented");
     }
-    return SComplexPtr(new SComplexType(3, dims, kappaMap, 1));
 }
 
 template <typename Traits>
-typename SComplexFactory<SComplex<Traits> >::SComplexPtr
-SComplexFactory<SComplex<Traits> >::Create(DebugComplexType type)
+bool SComplexFactory<SComplex<Traits> >::CreateKappaMap(DebugComplexType type,
+                                                        Dims& dims, KappaMapBufferType& kappaMap)
 {
-    Dims dims;
-    KappaMap kappaMap;
-    KappaMapSupplier<Id, int, Dim>::Create(type, dims, kappaMap);
-    return SComplexPtr(new SComplexType(3, dims, kappaMap, 1));
+    KappaMapSupplier<Id, signed char, Dim>::Create(type, dims, kappaMap);
+    return true;
 }
 
 template <typename Traits>
@@ -132,6 +189,16 @@ SComplexFactory<SComplex<Traits> >::Create(Dims& dims, KappaMap& kappaMap)
     return SComplexPtr(new SComplexType(3, dims, kappaMap, 1));
 }
 
+template <typename Traits>
+typename SComplexFactory<SComplex<Traits> >::SComplexPtr
+SComplexFactory<SComplex<Traits> >::Create(Dims& dims, KappaMapBufferType& kappaMap)
+{
+    // buffer is released chunk by chunk while the entries are converted
+    KappaMap entries;
+    kappaMap.MoveTo(entries);
+    return Create(dims, entries);
+}
+
 template <typename Traits>
 typename SComplexFactory<SComplex<Traits> >::FileType
 SComplexFactory<SComplex<Traits> >::DetermineFileType(const char* filename)
@@ -20,11 +20,20 @@ public:
     typedef std::set<Id>            Simplex;
     typedef std::vector<Simplex>    Simplices;
 
-    static void Load(const char* filename, Simplices& simplices);
+    // simplices of dimension greater than maxDim (if nonnegative) are
+    // replaced by their faces of dimension maxDim
+    static void Load(const char* filename, Simplices& simplices, int maxDim = -1);
     static void Create(DebugComplexType type, Simplices& simplices);
 
 private:
 
+    typedef std::set<Simplex>       SimplicesSet;
+
+    // appends faces of the simplex with the given number of vertices
+    // which have not been appended yet
+    static void AddFaces(const Simplex& simplex, int verticesCount,
+                         Simplices& simplices, SimplicesSet& faces);
+
     static void FillS1(Simplices& simplices);
     static void FillS2(Simplices& simplices);
     static void FillTorus(Simplices& simplices);
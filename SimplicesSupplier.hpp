@@ -11,7 +11,7 @@
 #include <fstream>
 
 template <typename T>
-void SimplicesSupplier<T>::Load(const char* filename, Simplices& simplices)
+void SimplicesSupplier<T>::Load(const char* filename, Simplices& simplices, int maxDim)
 {
     std::ifstream input(filename);
     if (!input.is_open())
@@ -20,6 +20,7 @@ void SimplicesSupplier<T>::Load(const char* filename, Simplices& simplices)
     }
 
     simplices.clear();
+    SimplicesSet faces;
     std::string line;
     while (getline(input, line))
     {
@@ -34,10 +35,55 @@ void SimplicesSupplier<T>::Load(const char* filename, Simplices& simplices)
         {
             simplex.insert(static_cast<Id>(token));
         }
+        if (maxDim >= 0 && static_cast<int>(simplex.size()) > maxDim + 1)
+        {
+            AddFaces(simplex, maxDim + 1, simplices, faces);
+            continue;
+        }
         simplices.push_back(simplex);
     }
 }
 
+template <typename T>
+void SimplicesSupplier<T>::AddFaces(const Simplex& simplex, int verticesCount,
+                                    Simplices& simplices, SimplicesSet& faces)
+{
+    std::vector<Id> vertices(simplex.begin(), simplex.end());
+    int n = vertices.size();
+    // indices of the vertices of the current face, in lexicographic order
+    std::vector<int> indices(verticesCount);
+    for (int i = 0; i < verticesCount; i++)
+    {
+        indices[i] = i;
+    }
+    while (true)
+    {
+        Simplex face;
+        for (int i = 0; i < verticesCount; i++)
+        {
+            face.insert(vertices[indices[i]]);
+        }
+        if (faces.insert(face).second)
+        {
+            simplices.push_back(face);
+        }
+        int i = verticesCount - 1;
+        while (i >= 0 && indices[i] == n - verticesCount + i)
+        {
+            i--;
+        }
+        if (i < 0)
+        {
+            break;
+        }
+        indices[i]++;
+        for (int j = i + 1; j < verticesCount; j++)
+        {
+            indices[j] = indices[j - 1] + 1;
+        }
+    }
+}
+
 template <typename T>
 void SimplicesSupplier<T>::Create(DebugComplexType type, Simplices& simplices)
 {
@@ -0,0 +1,56 @@
+/*
+ * File:   SmithNormalForm.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef SMITHNORMALFORM_H
+#define	SMITHNORMALFORM_H
+
+#include <set>
+#include <utility>
+#include <vector>
+
+// Sparse integer matrix reduced to a diagonal form by unimodular row and
+// column operations. Units are used as pivots first (they never produce
+// remainders), the remaining part is reduced with the smallest pivots.
+template <typename IntT = long long>
+class SmithNormalForm
+{
+public:
+
+    typedef IntT                            Int;
+    typedef std::pair<int, Int>             Entry;
+    typedef std::vector<Entry>              Row;
+
+    SmithNormalForm(int columnsCount);
+
+    // entries may come in any order, repeated columns are summed up
+    void AddRow(const Row& row);
+
+    // computes nonzero diagonal entries (in no particular order)
+    void Compute(std::vector<Int>& diagonal);
+
+    // abelian invariants of the group presented by the matrix rows
+    // in the format used by GAP: prime powers and zeros, sorted
+    void ComputeAbelianInvariants(std::vector<Int>& invariants);
+
+private:
+
+    int                             _columnsCount;
+    std::vector<Row>                _rows;
+    std::vector<std::set<int> >     _columnRows;
+    std::vector<bool>               _activeRows;
+
+    bool FindUnitPivot(int row, int& column);
+    bool FindSmallestPivot(int& row, int& column);
+    bool EliminatePivot(int& row, int& column);
+    void RemoveRow(int row);
+    void SubtractRow(int row, Int factor, int pivotRow);
+    Int GetEntry(int row, int column);
+    static bool CompareColumns(const Entry& a, const Entry& b);
+    static Int Abs(Int value);
+};
+
+#include "SmithNormalForm.hpp"
+
+#endif	/* SMITHNORMALFORM_H */
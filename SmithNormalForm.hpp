@@ -0,0 +1,345 @@
+/*
+ * File:   SmithNormalForm.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef SMITHNORMALFORM_HPP
+#define	SMITHNORMALFORM_HPP
+
+#include "SmithNormalForm.h"
+
+#include <algorithm>
+#include <cassert>
+
+template <typename IntT>
+SmithNormalForm<IntT>::SmithNormalForm(int columnsCount)
+    : _columnsCount(columnsCount)
+    , _columnRows(columnsCount)
+{
+}
+
+template <typename IntT>
+void SmithNormalForm<IntT>::AddRow(const Row& row)
+{
+    Row sorted(row);
+    std::sort(sorted.begin(), sorted.end());
+    Row newRow;
+    typename Row::iterator it = sorted.begin();
+    typename Row::iterator itEnd = sorted.end();
+    for ( ; it != itEnd; ++it)
+    {
+        assert(it->first >= 0 && it->first < _columnsCount);
+        if (newRow.size() > 0 && newRow.back().first == it->first)
+        {
+            newRow.back().second += it->second;
+            if (newRow.back().second == 0)
+            {
+                newRow.pop_back();
+            }
+        }
+        else if (it->second != 0)
+        {
+            newRow.push_back(*it);
+        }
+    }
+    if (newRow.size() == 0)
+    {
+        return;
+    }
+    int index = static_cast<int>(_rows.size());
+    for (it = newRow.begin(); it != newRow.end(); ++it)
+    {
+        _columnRows[it->first].insert(index);
+    }
+    _rows.push_back(newRow);
+    _activeRows.push_back(true);
+}
+
+template <typename IntT>
+void SmithNormalForm<IntT>::Compute(std::vector<Int>& diagonal)
+{
+    diagonal.clear();
+    int rowsCount = static_cast<int>(_rows.size());
+
+    // unit pivots never leave remainders, so every one of them
+    // removes its row and column in a single step
+    bool found = true;
+    while (found)
+    {
+        found = false;
+        for (int row = 0; row < rowsCount; row++)
+        {
+            int column = 0;
+            if (_activeRows[row] && FindUnitPivot(row, column))
+            {
+                // a unit pivot is eliminated in one step, anything
+                // left would be reduced by the loop below
+                Int pivot = GetEntry(row, column);
+                if (EliminatePivot(row, column))
+                {
+                    diagonal.push_back(Abs(pivot));
+                    found = true;
+                }
+            }
+        }
+    }
+
+    // what is left is reduced with the smallest available pivots
+    int row = 0;
+    int column = 0;
+    while (FindSmallestPivot(row, column))
+    {
+        Int pivot = GetEntry(row, column);
+        while (!EliminatePivot(row, column))
+        {
+            pivot = GetEntry(row, column);
+        }
+        diagonal.push_back(Abs(pivot));
+    }
+}
+
+template <typename IntT>
+void SmithNormalForm<IntT>::ComputeAbelianInvariants(std::vector<Int>& invariants)
+{
+    std::vector<Int> diagonal;
+    Compute(diagonal);
+    invariants.clear();
+    for (int i = static_cast<int>(diagonal.size()); i < _columnsCount; i++)
+    {
+        invariants.push_back(0);
+    }
+    typename std::vector<Int>::iterator it = diagonal.begin();
+    typename std::vector<Int>::iterator itEnd = diagonal.end();
+    for ( ; it != itEnd; ++it)
+    {
+        // splitting into prime powers
+        Int value = *it;
+        for (Int p = 2; p * p <= value; p++)
+        {
+            Int power = 1;
+            while (value % p == 0)
+            {
+                value /= p;
+                power *= p;
+            }
+            if (power > 1)
+            {
+                invariants.push_back(power);
+            }
+        }
+        if (value > 1)
+        {
+            invariants.push_back(value);
+        }
+    }
+    std::sort(invariants.begin(), invariants.end());
+}
+
+template <typename IntT>
+bool SmithNormalForm<IntT>::FindUnitPivot(int row, int& column)
+{
+    // unit with the sparsest column (the smallest fill-in)
+    size_t bestCount = 0;
+    bool found = false;
+    typename Row::iterator it = _rows[row].begin();
+    typename Row::iterator itEnd = _rows[row].end();
+    for ( ; it != itEnd; ++it)
+    {
+        if (Abs(it->second) == 1)
+        {
+            size_t count = _columnRows[it->first].size();
+            if (!found || count < bestCount)
+            {
+                column = it->first;
+                bestCount = count;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+template <typename IntT>
+bool SmithNormalForm<IntT>::FindSmallestPivot(int& row, int& column)
+{
+    bool found = false;
+    Int best = 0;
+    for (int i = 0; i < static_cast<int>(_rows.size()); i++)
+    {
+        if (!_activeRows[i])
+        {
+            continue;
+        }
+        typename Row::iterator it = _rows[i].begin();
+        typename Row::iterator itEnd = _rows[i].end();
+        for ( ; it != itEnd; ++it)
+        {
+            if (!found || Abs(it->second) < best)
+            {
+                row = i;
+                column = it->first;
+                best = Abs(it->second);
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+template <typename IntT>
+bool SmithNormalForm<IntT>::EliminatePivot(int& row, int& column)
+{
+    Int pivot = GetEntry(row, column);
+    assert(pivot != 0);
+
+    // clearing the pivot column with row operations
+    std::vector<int> rows(_columnRows[column].begin(), _columnRows[column].end());
+    int remainderRow = -1;
+    Int remainder = 0;
+    std::vector<int>::iterator it = rows.begin();
+    std::vector<int>::iterator itEnd = rows.end();
+    for ( ; it != itEnd; ++it)
+    {
+        if (*it == row)
+        {
+            continue;
+        }
+        Int factor = GetEntry(*it, column) / pivot;
+        if (factor != 0)
+        {
+            SubtractRow(*it, factor, row);
+        }
+        Int value = GetEntry(*it, column);
+        if (value != 0 && (remainderRow == -1 || Abs(value) < remainder))
+        {
+            remainderRow = *it;
+            remainder = Abs(value);
+        }
+    }
+    if (remainderRow != -1)
+    {
+        // smaller entry left in the column becomes the new pivot
+        row = remainderRow;
+        return false;
+    }
+
+    // now the pivot is the only entry in its column, so column operations
+    // change the pivot row only and we can reduce it modulo the pivot
+    Row newRow;
+    int remainderColumn = -1;
+    typename Row::iterator jt = _rows[row].begin();
+    typename Row::iterator jtEnd = _rows[row].end();
+    for ( ; jt != jtEnd; ++jt)
+    {
+        if (jt->first == column)
+        {
+            newRow.push_back(*jt);
+            continue;
+        }
+        Int value = jt->second % pivot;
+        if (value != 0)
+        {
+            newRow.push_back(Entry(jt->first, value));
+            if (remainderColumn == -1 || Abs(value) < remainder)
+            {
+                remainderColumn = jt->first;
+                remainder = Abs(value);
+            }
+        }
+        else
+        {
+            _columnRows[jt->first].erase(row);
+        }
+    }
+    _rows[row].swap(newRow);
+    if (remainderColumn != -1)
+    {
+        column = remainderColumn;
+        return false;
+    }
+
+    RemoveRow(row);
+    return true;
+}
+
+template <typename IntT>
+void SmithNormalForm<IntT>::RemoveRow(int row)
+{
+    typename Row::iterator it = _rows[row].begin();
+    typename Row::iterator itEnd = _rows[row].end();
+    for ( ; it != itEnd; ++it)
+    {
+        _columnRows[it->first].erase(row);
+    }
+    Row().swap(_rows[row]);
+    _activeRows[row] = false;
+}
+
+template <typename IntT>
+void SmithNormalForm<IntT>::SubtractRow(int row, Int factor, int pivotRow)
+{
+    // row := row - factor * pivotRow, both rows are sorted by column
+    const Row& a = _rows[row];
+    const Row& b = _rows[pivotRow];
+    Row result;
+    result.reserve(a.size() + b.size());
+    typename Row::const_iterator it = a.begin();
+    typename Row::const_iterator jt = b.begin();
+    while (it != a.end() || jt != b.end())
+    {
+        if (jt == b.end() || (it != a.end() && it->first < jt->first))
+        {
+            result.push_back(*it++);
+        }
+        else if (it == a.end() || jt->first < it->first)
+        {
+            result.push_back(Entry(jt->first, -factor * jt->second));
+            _columnRows[jt->first].insert(row);
+            ++jt;
+        }
+        else
+        {
+            Int value = it->second - factor * jt->second;
+            if (value != 0)
+            {
+                result.push_back(Entry(it->first, value));
+            }
+            else
+            {
+                _columnRows[it->first].erase(row);
+            }
+            ++it;
+            ++jt;
+        }
+    }
+    _rows[row].swap(result);
+}
+
+template <typename IntT>
+typename SmithNormalForm<IntT>::Int
+SmithNormalForm<IntT>::GetEntry(int row, int column)
+{
+    const Row& r = _rows[row];
+    typename Row::const_iterator it = std::lower_bound(r.begin(), r.end(), Entry(column, Int()),
+                                                       CompareColumns);
+    if (it != r.end() && it->first == column)
+    {
+        return it->second;
+    }
+    return 0;
+}
+
+template <typename IntT>
+bool SmithNormalForm<IntT>::CompareColumns(const Entry& a, const Entry& b)
+{
+    return a.first < b.first;
+}
+
+template <typename IntT>
+typename SmithNormalForm<IntT>::Int
+SmithNormalForm<IntT>::Abs(Int value)
+{
+    return value < 0 ? -value : value;
+}
+
+#endif	/* SMITHNORMALFORM_HPP */
@@ -10,17 +10,81 @@
 #include "AKQReducedSComplexSupplier.h"
 #include "NotReducedSComplexSupplier.h"
 #include "CollapsedAKQReducedCubSComplexSupplier.h"
+#include "CollapsedAKQReducedSComplexSupplier.h"
 #include "FundGroup.h"
 #include "HomologyTraits.h"
+#include "SComplexFactory.h"
 
 #include "FGLogger.h"
 
+#include <cstdio>
+#include <fstream>
+
 ////////////////////////////////////////////////////////////////////////////////
 
 ComplexType Tests::complexType = CT_SComplex;
 ReductionType Tests::reductionType = RT_Coreductions;
 std::string Tests::inputFilename = "tests.txt";
 std::string Tests::hapProgramFilename = "";
+FGOptions Tests::options;
+bool Tests::runTests = false;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// complex with one vertex, a loop for every generator and a 2-cell for
+// every relator, it gives the presentation directly to FundGroup
+class RelatorsSupplier
+{
+public:
+
+    typedef int                                 Id;
+    typedef std::set<Id>                        Cells;
+    typedef std::vector<Cells>                  CellsByDim;
+    typedef std::vector<std::pair<Id, int> >    Chain;
+    typedef WordArena<Id>                       Chains;
+
+    // generators are numbered from 1, relators are given as (generator, exponent)
+    RelatorsSupplier(int generatorsCount, const std::vector<Chain>& relators)
+        : _generatorsCount(generatorsCount)
+        , _relators(relators)
+    {
+    }
+
+    bool GetCells(CellsByDim& cellsByDim, Chains& _2Boundaries)
+    {
+        cellsByDim.assign(3, Cells());
+        cellsByDim[0].insert(0);
+        for (int i = 1; i <= _generatorsCount; i++)
+        {
+            cellsByDim[1].insert(i);
+        }
+        for (size_t i = 0; i < _relators.size(); i++)
+        {
+            cellsByDim[2].insert(_generatorsCount + 1 + static_cast<Id>(i));
+            for (size_t j = 0; j < _relators[i].size(); j++)
+            {
+                _2Boundaries.Append(_relators[i][j].first, _relators[i][j].second);
+            }
+            _2Boundaries.EndWord();
+        }
+        return true;
+    }
+
+    Chain GetBoundary(const Id& cellId)
+    {
+        // every 1-cell is a loop
+        return Chain();
+    }
+
+    void PrintDebug()
+    {
+    }
+
+private:
+
+    int                 _generatorsCount;
+    std::vector<Chain>  _relators;
+};
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -41,13 +105,30 @@ void Tests::PrintHelp()
     std::cout<<"  --rt       - use reductions of type ["<<reductionType<<"]"<<std::endl;
     std::cout<<"               - 0 - no reductions"<<std::endl;
     std::cout<<"               - 1 - shaving + coreductions"<<std::endl;
-    std::cout<<"               - 2 - shaving + coreductions + collapsible subcomplex (only for cubical complexes)"<<std::endl;
+    std::cout<<"               - 2 - shaving + coreductions + collapsible subcomplex"<<std::endl;
     std::cout<<"  --h filename - write HAP program to the file ["<<hapProgramFilename<<"]"<<std::endl;
+    std::cout<<"  --ab       - compute abelian invariants of the group ["<<options._abelianInvariants<<"]"<<std::endl;
+    std::cout<<"  --threads n - use n threads for quotient complex and homotopic boundaries, 0 - one per core ["<<options._threadsCount<<"]"<<std::endl;
+    std::cout<<"  --stats filename - write homotopic paths statistics to the file ["<<options._statsFilename<<"]"<<std::endl;
+    std::cout<<"  --iterate  - eliminate generators until no more can be removed ["<<options._iterateReductions<<"]"<<std::endl;
+    std::cout<<"  --order n  - order of cells for coreductions of complexes given by kappa maps (--rt 1 with *.kap input, --rt 2) ["<<options._orderPolicy<<"]"<<std::endl;
+    std::cout<<"               - 0 - default"<<std::endl;
+    std::cout<<"               - 1 - lowest degree first"<<std::endl;
+    std::cout<<"               - 2 - BFS from the boundary"<<std::endl;
+    std::cout<<"               - 3 - random"<<std::endl;
+    std::cout<<"  --restarts n - try n random orders and keep the best one ["<<options._orderRestarts<<"]"<<std::endl;
+    std::cout<<"  --lean     - release intermediate data between phases ["<<options._leanMemory<<"]"<<std::endl;
+    std::cout<<"  --checkpoint filename - read cells and homotopic boundaries from the file or write them there ["<<options._checkpointFilename<<"]"<<std::endl;
+    std::cout<<"  --thresholds t1 [t2 ...] - sublevel sets of grayscale input (--ct 2 or 3, --rt 2), sweep through all thresholds"<<std::endl;
+    std::cout<<"  --test     - run self checks instead of computing the input"<<std::endl;
+    std::cout<<"  --skeleton n - discard cells of dim > n (n >= 2) of kappa maps and simplices, -1 - keep all ["<<options._skeletonDim<<"]"<<std::endl;
     std::cout<<std::endl;
     std::cout<<"possible input formats:"<<std::endl;
     std::cout<<"*.sim - list of maximal simplices"<<std::endl;
     std::cout<<"*.kap - kappa map"<<std::endl;
     std::cout<<"*.hap - hap-exported bitmap of cubes"<<std::endl;
+    std::cout<<"*.pgm - grayscale image (P2 or P5), consecutive images are slices of a volume"<<std::endl;
+    std::cout<<"*.raw - grayscale volume of 8 or 16 bit voxels named name_WxH.raw or name_WxHxD.raw"<<std::endl;
     std::cout<<"other - list of maximal cubes"<<std::endl;
     std::cout<<std::endl;
 }
@@ -84,6 +165,75 @@ void Tests::ProcessArgument(std::vector<std::string> &args)
         CC("h", 1)
         hapProgramFilename = args[1];
     }
+    else if (arg == "ab")
+    {
+        CC("ab", 0)
+        options._abelianInvariants = true;
+    }
+    else if (arg == "threads")
+    {
+        CC("threads", 1)
+        options._threadsCount = atoi(args[1].c_str());
+    }
+    else if (arg == "stats")
+    {
+        CC("stats", 1)
+        options._statsFilename = args[1];
+    }
+    else if (arg == "iterate")
+    {
+        CC("iterate", 0)
+        options._iterateReductions = true;
+    }
+    else if (arg == "order")
+    {
+        CC("order", 1)
+        options._orderPolicy = static_cast<OrderPolicy>(atoi(args[1].c_str()));
+    }
+    else if (arg == "restarts")
+    {
+        CC("restarts", 1)
+        options._orderRestarts = atoi(args[1].c_str());
+    }
+    else if (arg == "lean")
+    {
+        CC("lean", 0)
+        options._leanMemory = true;
+    }
+    else if (arg == "checkpoint")
+    {
+        CC("checkpoint", 1)
+        options._checkpointFilename = args[1];
+    }
+    else if (arg == "thresholds")
+    {
+        if (args.size() < 2)
+        {
+            std::cout<<"Error: thresholds expects at least 1 param"<<std::endl;
+            return;
+        }
+        options._thresholds.clear();
+        for (size_t i = 1; i < args.size(); i++)
+        {
+            options._thresholds.push_back(atoi(args[i].c_str()));
+        }
+    }
+    else if (arg == "test")
+    {
+        CC("test", 0)
+        runTests = true;
+    }
+    else if (arg == "skeleton")
+    {
+        CC("skeleton", 1)
+        int skeletonDim = atoi(args[1].c_str());
+        if (skeletonDim != -1 && skeletonDim < 2)
+        {
+            std::cout<<"Error: skeleton expects -1 or n >= 2 (fundamental group needs the 2-skeleton)"<<std::endl;
+            return;
+        }
+        options._skeletonDim = skeletonDim;
+    }
     else
     {
         std::cout<<"Unknown argument: "<<arg<<std::endl;
@@ -126,10 +276,31 @@ void Tests::TestFromCommandLine(int argc, char **argv)
     logger.Begin(FGLogger::Output, "Use FundGroup --help for more info");
 
     ProcessArguments(argc, argv);
+    if (runTests)
+    {
+        Test();
+        logger.End();
+        return;
+    }
     logger.Log(FGLogger::Output)<<"complex type: "<<complexType<<std::endl;
     logger.Log(FGLogger::Output)<<"reduction type: "<<reductionType<<std::endl;
     logger.Log(FGLogger::Output)<<"input: "<<inputFilename<<std::endl;
 
+    if (options._thresholds.size() > 1 && reductionType == RT_CoreductionsCollapsible
+        && (complexType == CT_Cubical_2 || complexType == CT_Cubical_3))
+    {
+        if (complexType == CT_Cubical_2)
+        {
+            SweepThresholds<2>();
+        }
+        else
+        {
+            SweepThresholds<3>();
+        }
+        logger.End();
+        return;
+    }
+
     IFundGroup* fg = CreateFundGroupAlgorithm();
     logger.Log(FGLogger::Output)<<*fg<<std::endl;
 
@@ -142,58 +313,212 @@ void Tests::TestFromCommandLine(int argc, char **argv)
     logger.End();
 }
 
+void Tests::Test()
+{
+    FGLogger logger;
+    bool passed = true;
+    if (!TestEliminationThroughInverse())
+    {
+        logger.Log(FGLogger::Output)<<"FAILED: elimination through inverse letter"<<std::endl;
+        passed = false;
+    }
+    if (!TestCubeEditing())
+    {
+        logger.Log(FGLogger::Output)<<"FAILED: cube insertion and removal"<<std::endl;
+        passed = false;
+    }
+    logger.Log(FGLogger::Output)<<(passed ? "all checks passed" : "some checks failed")<<std::endl;
+}
+
+bool Tests::TestEliminationThroughInverse()
+{
+    // <a, b | a^-1 b, a^-1 b^-1>, eliminating a = b through the first
+    // relator turns the second one into b^-2, so the group is Z_2
+    typedef RelatorsSupplier::Chain Chain;
+    std::vector<Chain> relators(2);
+    relators[0].push_back(std::make_pair(1, -1));
+    relators[0].push_back(std::make_pair(2, 1));
+    relators[1].push_back(std::make_pair(1, -1));
+    relators[1].push_back(std::make_pair(2, -1));
+
+    FGOptions testOptions;
+    testOptions._iterateReductions = true;
+    testOptions._abelianInvariants = true;
+    boost::shared_ptr<RelatorsSupplier> supplier(new RelatorsSupplier(2, relators));
+    FundGroup<RelatorsSupplier> fg(supplier, testOptions);
+
+    // one generator, one relator of one syllable: f1^-2
+    int expected[] = { 1, 1, 1, 1, -2 };
+    std::vector<int> presentation = fg.HapInterfaceVector();
+    return presentation == std::vector<int>(expected, expected + 5)
+           && fg.GetAbelianInvariants() == std::vector<long long>(1, 2);
+}
+
+bool Tests::TestCubeEditing()
+{
+    // a tube (3x3 ring extruded along the last axis) is shaved down to its
+    // top ring, plugging the top ring and removing the plug again has to
+    // give the groups of the plugged and the open tube and it has to be
+    // done by emitting again only the slabs next to the top
+    typedef CubicalHomology<3> Traits;
+    typedef CollapsedAKQReducedCubSComplexSupplier<Traits> Supplier;
+
+    const int height = 48;
+    const char* tubeFilename = "test_tube.txt";
+    const char* pluggedFilename = "test_plugged_tube.txt";
+    WriteTube(tubeFilename, height, false);
+    WriteTube(pluggedFilename, height, true);
+
+    FGOptions testOptions;
+    testOptions._iterateReductions = true;
+    testOptions._abelianInvariants = true;
+    FundGroup<Supplier> pluggedFg(pluggedFilename, testOptions);
+    std::vector<long long> plugged = pluggedFg.GetAbelianInvariants();
+
+    testOptions._editable = true;
+    boost::shared_ptr<Supplier> supplier(new Supplier(tubeFilename, testOptions));
+    FundGroup<Supplier> fg(supplier, testOptions);
+    std::vector<long long> unedited = fg.GetAbelianInvariants();
+    std::remove(tubeFilename);
+    std::remove(pluggedFilename);
+    if (unedited == plugged)
+    {
+        return false;
+    }
+
+    int coords[3] = { 1, 1, height - 1 };
+    if (supplier->HasCube(coords) || !supplier->InsertCube(coords) || !supplier->Update())
+    {
+        return false;
+    }
+    fg.Recompute();
+    const Supplier::UpdateStats& stats = supplier->GetUpdateStats();
+    if (fg.GetAbelianInvariants() != plugged || stats._emittedSlabs >= stats._slabsCount)
+    {
+        return false;
+    }
+
+    if (!supplier->RemoveCube(coords) || !supplier->Update())
+    {
+        return false;
+    }
+    fg.Recompute();
+    return fg.GetAbelianInvariants() == unedited && stats._emittedSlabs < stats._slabsCount;
+}
+
+void Tests::WriteTube(const char* filename, int height, bool plugged)
+{
+    // full cubes, one per line
+    std::ofstream output(filename);
+    for (int z = 0; z < height; z++)
+    {
+        for (int y = 0; y < 3; y++)
+        {
+            for (int x = 0; x < 3; x++)
+            {
+                if (x != 1 || y != 1 || (plugged && z == height - 1))
+                {
+                    output<<x<<" "<<y<<" "<<z<<std::endl;
+                }
+            }
+        }
+    }
+}
+
+template <int DIM>
+void Tests::SweepThresholds()
+{
+    typedef CollapsedAKQReducedCubSComplexSupplier<CubicalHomology<DIM> > Supplier;
+    FGLogger logger;
+
+    // the input set of the first level is edited into the next levels,
+    // the volume is read and sorted by value once, every level visits only
+    // its own voxels and reuses the shaving of the previous level
+    FGOptions sweepOptions = options;
+    sweepOptions._editable = true;
+    boost::shared_ptr<Supplier> supplier(new Supplier(inputFilename.c_str(), sweepOptions));
+    FundGroup<Supplier> fg(supplier, sweepOptions);
+    logger.Log(FGLogger::Output)<<"threshold "<<options._thresholds[0]<<": "<<fg<<std::endl;
+
+    for (size_t i = 1; i < options._thresholds.size(); i++)
+    {
+        logger.Begin(FGLogger::Details, "computing next level");
+        supplier->SetThreshold(options._thresholds[i]);
+        if (supplier->Update())
+        {
+            fg.Recompute();
+        }
+        logger.End();
+        logger.Log(FGLogger::Output)<<"threshold "<<options._thresholds[i]<<": "<<fg<<std::endl;
+    }
+
+    if (hapProgramFilename != "")
+    {
+        // program of the last level
+        fg.ExportHapProgram(hapProgramFilename.c_str());
+    }
+}
+
 IFundGroup* Tests::CreateFundGroupAlgorithm()
 {
     if (complexType == CT_SComplex)
     {
         if (reductionType == RT_None)
         {
-            return new FundGroup<NotReducedSComplexSupplier<SComplexHomology> >(inputFilename.c_str());
+            return new FundGroup<NotReducedSComplexSupplier<SComplexHomology> >(inputFilename.c_str(), options);
+        }
+        else if (reductionType == RT_Coreductions)
+        {
+            return new FundGroup<AKQReducedSComplexSupplier<SComplexHomology> >(inputFilename.c_str(), options);
         }
         else
         {
-            return new FundGroup<AKQReducedSComplexSupplier<SComplexHomology> >(inputFilename.c_str());
+            return new FundGroup<CollapsedAKQReducedSComplexSupplier<SComplexHomology> >(inputFilename.c_str(), options);
         }
     }
     else if (complexType == CT_Simplicial)
     {
         if (reductionType == RT_None)
         {
-            return new FundGroup<NotReducedSComplexSupplier<SimplicialHomology> >(inputFilename.c_str());
+            return new FundGroup<NotReducedSComplexSupplier<SimplicialHomology> >(inputFilename.c_str(), options);
+        }
+        else if (reductionType == RT_Coreductions)
+        {
+            return new FundGroup<AKQReducedSComplexSupplier<SimplicialHomology> >(inputFilename.c_str(), options);
         }
         else
         {
-            return new FundGroup<AKQReducedSComplexSupplier<SimplicialHomology> >(inputFilename.c_str());
+            return new FundGroup<CollapsedAKQReducedSComplexSupplier<SimplicialHomology> >(inputFilename.c_str(), options);
         }
     }
     else if (complexType == CT_Cubical_2)
     {
         if (reductionType == RT_None)
         {
-            return new FundGroup<NotReducedSComplexSupplier<CubicalHomology<2> > >(inputFilename.c_str());
+            return new FundGroup<NotReducedSComplexSupplier<CubicalHomology<2> > >(inputFilename.c_str(), options);
         }
         else if (reductionType == RT_Coreductions)
         {
-            return new FundGroup<AKQReducedSComplexSupplier<CubicalHomology<2> > >(inputFilename.c_str());
+            return new FundGroup<AKQReducedSComplexSupplier<CubicalHomology<2> > >(inputFilename.c_str(), options);
         }
         else
         {
-            return new FundGroup<CollapsedAKQReducedCubSComplexSupplier<CubicalHomology<2> > >(inputFilename.c_str());
+            return new FundGroup<CollapsedAKQReducedCubSComplexSupplier<CubicalHomology<2> > >(inputFilename.c_str(), options);
         }
     }
     else
     {
         if (reductionType == RT_None)
         {
-            return new FundGroup<NotReducedSComplexSupplier<CubicalHomology<3> > >(inputFilename.c_str());
+            return new FundGroup<NotReducedSComplexSupplier<CubicalHomology<3> > >(inputFilename.c_str(), options);
         }
         else if (reductionType == RT_Coreductions)
         {
-            return new FundGroup<AKQReducedSComplexSupplier<CubicalHomology<3> > >(inputFilename.c_str());
+            return new FundGroup<AKQReducedSComplexSupplier<CubicalHomology<3> > >(inputFilename.c_str(), options);
         }
         else
         {
-            return new FundGroup<CollapsedAKQReducedCubSComplexSupplier<CubicalHomology<3> > >(inputFilename.c_str());
+            return new FundGroup<CollapsedAKQReducedCubSComplexSupplier<CubicalHomology<3> > >(inputFilename.c_str(), options);
         }
     }
     return nullptr;
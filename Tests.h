@@ -9,6 +9,8 @@
 #include <vector>
 #include <string>
 
+#include "FGOptions.h"
+
 enum ComplexType
 {
     CT_SComplex,
@@ -36,13 +38,21 @@ private:
     static ReductionType    reductionType;
     static std::string      inputFilename;
     static std::string      hapProgramFilename;
+    static FGOptions        options;
+    static bool             runTests;
 
     static void PrintHelp();
     static void ProcessArgument(std::vector<std::string> &args);
     static void ProcessArguments(int, char **);
 
+    // self checks of the computations, run with --test
     static void Test();
+    static bool TestEliminationThroughInverse();
+    static bool TestCubeEditing();
+    static void WriteTube(const char* filename, int height, bool plugged);
     static class IFundGroup* CreateFundGroupAlgorithm();
+    template <int DIM>
+    static void SweepThresholds();
 };
 
 #endif	/* TESTS_H */
@@ -0,0 +1,84 @@
+/*
+ * File:   WordArena.h
+ * Author: Piotr Brendel
+ */
+
+#ifndef WORDARENA_H
+#define	WORDARENA_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Contiguous storage for many words over cell ids (relators, 2-boundaries).
+// All letters live in one array and words are delimited by an offsets table
+// (CSR layout). Every letter is a generator with exponent +1 or -1 packed into
+// a single signed integer: +(id + 1) or -(id + 1). Exponents of greater
+// magnitude are stored as repeated letters.
+template <typename IdT>
+class WordArena
+{
+public:
+
+    typedef IdT                             Id;
+    typedef int                             Letter;
+    typedef const Letter*                   LetterIterator;
+    typedef std::pair<Id, int>              Syllable;
+    typedef std::vector<Syllable>           Syllables;
+    typedef std::vector<Letter>             Word;
+
+    WordArena();
+
+    static Letter MakeLetter(const Id& id, int sign);
+    static Id GetId(Letter letter);
+    static int GetSign(Letter letter);
+
+    // appends letters to the currently open word
+    void Append(Letter letter);
+    void Append(const Id& id, int exponent);
+    void Append(LetterIterator begin, LetterIterator end);
+    // appends all the words of other arena (no word can be open)
+    void AppendWords(const WordArena& other);
+    // appends letters cancelling them against the end of currently open word
+    void AppendReduced(Letter letter);
+    void AppendReduced(const Id& id, int exponent);
+    // closes currently open word, an empty word is stored as well
+    void EndWord();
+    // drops all letters of currently open word
+    void DiscardWord();
+
+    void Clear();
+    void Reserve(size_t wordsCount, size_t lettersCount);
+    void Swap(WordArena& other);
+
+    size_t WordsCount() const;
+    size_t LettersCount() const;
+    size_t WordLength(size_t word) const;
+    LetterIterator WordBegin(size_t word) const;
+    LetterIterator WordEnd(size_t word) const;
+
+    // merges runs of equal letters into (id, exponent) pairs
+    void GetSyllables(size_t word, Syllables& syllables) const;
+
+    // removes all subwords x x^-1
+    static void FreeReduce(Word& word);
+    // removes matching first and last letters of freely reduced word
+    static void CyclicReduce(Word& word);
+    // replaces cyclically reduced word with the lexicographically least
+    // rotation of the word and its inverse, so that all conjugates
+    // (and their inverses) share the same representation
+    static void Canonicalize(Word& word);
+
+private:
+
+    static size_t LeastRotation(const Word& word);
+
+    std::vector<Letter> _letters;
+    // _offsets[i] is the beginning of i-th word,
+    // the last entry is the beginning of currently open word
+    std::vector<size_t> _offsets;
+};
+
+#include "WordArena.hpp"
+
+#endif	/* WORDARENA_H */
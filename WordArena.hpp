@@ -0,0 +1,283 @@
+/*
+ * File:   WordArena.hpp
+ * Author: Piotr Brendel
+ */
+
+#ifndef WORDARENA_HPP
+#define	WORDARENA_HPP
+
+#include "WordArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+template <typename IdT>
+WordArena<IdT>::WordArena()
+{
+    _offsets.push_back(0);
+}
+
+template <typename IdT>
+typename WordArena<IdT>::Letter
+WordArena<IdT>::MakeLetter(const Id& id, int sign)
+{
+    assert(sign == 1 || sign == -1);
+    assert(static_cast<long long>(id) < static_cast<long long>(INT_MAX));
+    Letter letter = static_cast<Letter>(id) + 1;
+    return sign > 0 ? letter : -letter;
+}
+
+template <typename IdT>
+typename WordArena<IdT>::Id
+WordArena<IdT>::GetId(Letter letter)
+{
+    assert(letter != 0);
+    return static_cast<Id>((letter > 0 ? letter : -letter) - 1);
+}
+
+template <typename IdT>
+int WordArena<IdT>::GetSign(Letter letter)
+{
+    assert(letter != 0);
+    return letter > 0 ? 1 : -1;
+}
+
+template <typename IdT>
+void WordArena<IdT>::Append(Letter letter)
+{
+    assert(letter != 0);
+    _letters.push_back(letter);
+}
+
+template <typename IdT>
+void WordArena<IdT>::Append(const Id& id, int exponent)
+{
+    assert(exponent != 0);
+    Letter letter = MakeLetter(id, exponent > 0 ? 1 : -1);
+    int count = exponent > 0 ? exponent : -exponent;
+    _letters.insert(_letters.end(), count, letter);
+}
+
+template <typename IdT>
+void WordArena<IdT>::Append(LetterIterator begin, LetterIterator end)
+{
+    _letters.insert(_letters.end(), begin, end);
+}
+
+template <typename IdT>
+void WordArena<IdT>::AppendWords(const WordArena& other)
+{
+    assert(_letters.size() == _offsets.back());
+    size_t shift = _letters.size();
+    _letters.insert(_letters.end(), other._letters.begin(), other._letters.begin() + other._offsets.back());
+    _offsets.pop_back();
+    for (size_t i = 0; i < other._offsets.size(); i++)
+    {
+        _offsets.push_back(other._offsets[i] + shift);
+    }
+}
+
+template <typename IdT>
+void WordArena<IdT>::AppendReduced(Letter letter)
+{
+    assert(letter != 0);
+    if (_letters.size() > _offsets.back() && _letters.back() == -letter)
+    {
+        _letters.pop_back();
+    }
+    else
+    {
+        _letters.push_back(letter);
+    }
+}
+
+template <typename IdT>
+void WordArena<IdT>::AppendReduced(const Id& id, int exponent)
+{
+    assert(exponent != 0);
+    Letter letter = MakeLetter(id, exponent > 0 ? 1 : -1);
+    int count = exponent > 0 ? exponent : -exponent;
+    for (int i = 0; i < count; i++)
+    {
+        AppendReduced(letter);
+    }
+}
+
+template <typename IdT>
+void WordArena<IdT>::EndWord()
+{
+    _offsets.push_back(_letters.size());
+}
+
+template <typename IdT>
+void WordArena<IdT>::DiscardWord()
+{
+    _letters.resize(_offsets.back());
+}
+
+template <typename IdT>
+void WordArena<IdT>::Clear()
+{
+    _letters.clear();
+    _offsets.clear();
+    _offsets.push_back(0);
+}
+
+template <typename IdT>
+void WordArena<IdT>::Reserve(size_t wordsCount, size_t lettersCount)
+{
+    _offsets.reserve(wordsCount + 1);
+    _letters.reserve(lettersCount);
+}
+
+template <typename IdT>
+void WordArena<IdT>::Swap(WordArena& other)
+{
+    _letters.swap(other._letters);
+    _offsets.swap(other._offsets);
+}
+
+template <typename IdT>
+size_t WordArena<IdT>::WordsCount() const
+{
+    return _offsets.size() - 1;
+}
+
+template <typename IdT>
+size_t WordArena<IdT>::LettersCount() const
+{
+    return _offsets.back();
+}
+
+template <typename IdT>
+size_t WordArena<IdT>::WordLength(size_t word) const
+{
+    assert(word < WordsCount());
+    return _offsets[word + 1] - _offsets[word];
+}
+
+template <typename IdT>
+typename WordArena<IdT>::LetterIterator
+WordArena<IdT>::WordBegin(size_t word) const
+{
+    assert(word < WordsCount());
+    return _letters.data() + _offsets[word];
+}
+
+template <typename IdT>
+typename WordArena<IdT>::LetterIterator
+WordArena<IdT>::WordEnd(size_t word) const
+{
+    assert(word < WordsCount());
+    return _letters.data() + _offsets[word + 1];
+}
+
+template <typename IdT>
+void WordArena<IdT>::GetSyllables(size_t word, Syllables& syllables) const
+{
+    syllables.clear();
+    LetterIterator it = WordBegin(word);
+    LetterIterator itEnd = WordEnd(word);
+    while (it != itEnd)
+    {
+        Letter letter = *it;
+        int exponent = 0;
+        for ( ; it != itEnd && *it == letter; ++it)
+        {
+            exponent += GetSign(letter);
+        }
+        syllables.push_back(Syllable(GetId(letter), exponent));
+    }
+}
+
+template <typename IdT>
+void WordArena<IdT>::FreeReduce(Word& word)
+{
+    // in place stack-based reduction
+    size_t size = 0;
+    for (size_t i = 0; i < word.size(); i++)
+    {
+        if (size > 0 && word[size - 1] == -word[i])
+        {
+            size--;
+        }
+        else
+        {
+            word[size++] = word[i];
+        }
+    }
+    word.resize(size);
+}
+
+template <typename IdT>
+void WordArena<IdT>::CyclicReduce(Word& word)
+{
+    size_t begin = 0;
+    size_t end = word.size();
+    while (end - begin > 1 && word[begin] == -word[end - 1])
+    {
+        begin++;
+        end--;
+    }
+    word.erase(word.begin() + end, word.end());
+    word.erase(word.begin(), word.begin() + begin);
+}
+
+template <typename IdT>
+void WordArena<IdT>::Canonicalize(Word& word)
+{
+    if (word.empty())
+    {
+        return;
+    }
+    Word inverse(word.rbegin(), word.rend());
+    for (size_t i = 0; i < inverse.size(); i++)
+    {
+        inverse[i] = -inverse[i];
+    }
+    std::rotate(word.begin(), word.begin() + LeastRotation(word), word.end());
+    std::rotate(inverse.begin(), inverse.begin() + LeastRotation(inverse), inverse.end());
+    if (inverse < word)
+    {
+        word.swap(inverse);
+    }
+}
+
+template <typename IdT>
+size_t WordArena<IdT>::LeastRotation(const Word& word)
+{
+    // Booth's algorithm
+    size_t n = word.size();
+    std::vector<long> failure(2 * n, -1);
+    size_t k = 0;
+    for (size_t j = 1; j < 2 * n; j++)
+    {
+        Letter letter = word[j % n];
+        long i = failure[j - k - 1];
+        while (i != -1 && letter != word[(k + i + 1) % n])
+        {
+            if (letter < word[(k + i + 1) % n])
+            {
+                k = j - i - 1;
+            }
+            i = failure[i];
+        }
+        if (letter != word[(k + i + 1) % n])
+        {
+            // here i == -1
+            if (letter < word[k % n])
+            {
+                k = j;
+            }
+            failure[j - k] = -1;
+        }
+        else
+        {
+            failure[j - k] = i + 1;
+        }
+    }
+    return k % n;
+}
+
+#endif	/* WORDARENA_HPP */